@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ActorPoolSubsystem.h"
+#include "GardenGameCharacter.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+void UActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Gnomes placed in the level exist but have not begun play yet
+	TArray<UClass*> Classes;
+	for (TActorIterator<AGardenGameCharacter> It(&InWorld); It; ++It)
+		It->GetPooledActorClasses(Classes);
+	for (UClass* Class : Classes)
+		Prewarm(Class, PrewarmCount);
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	OnActorAcquired.Clear();
+	OnActorReleased.Clear();
+
+	Super::Deinitialize();
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count)
+{
+	if (!Class)
+		return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Class);
+	while (Pool.FreeActors.Num() < Count)
+	{
+		AActor* Actor = SpawnPooledActor(Class, FVector::ZeroVector, FRotator::ZeroRotator);
+		if (!Actor)
+			return;
+		Deactivate(Actor);
+		Pool.FreeActors.Add(Actor);
+	}
+}
+
+AActor* UActorPoolSubsystem::Acquire(TSubclassOf<AActor> Class, const FVector& Location, const FRotator& Rotation)
+{
+	if (!Class)
+		return nullptr;
+
+	FActorPool& Pool = Pools.FindOrAdd(Class);
+	while (Pool.FreeActors.Num() > 0)
+	{
+		AActor* Actor = Pool.FreeActors.Pop(false);
+		// Something else may have destroyed it while it was pooled
+		if (!IsValid(Actor))
+			continue;
+
+		Actor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		Activate(Actor);
+		OnActorAcquired.Broadcast(Actor);
+		return Actor;
+	}
+
+	// Pool ran dry, grow it
+	return SpawnPooledActor(Class, Location, Rotation);
+}
+
+void UActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor))
+		return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.FreeActors.Contains(Actor))
+		return;
+
+	Deactivate(Actor);
+	Pool.FreeActors.Add(Actor);
+	OnActorReleased.Broadcast(Actor);
+}
+
+AActor* UActorPoolSubsystem::SpawnPooledActor(TSubclassOf<AActor> Class, const FVector& Location, const FRotator& Rotation)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AActor>(Class, Location, Rotation, SpawnParams);
+}
+
+void UActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	// Nothing a released actor started may keep running, a turret's firing timer included
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	TimerManager.ClearAllTimersForObject(Actor);
+	Actor->ForEachComponent(false, [&TimerManager](UActorComponent* Component)
+	{
+		TimerManager.ClearAllTimersForObject(Component);
+		Component->SetComponentTickEnabled(false);
+	});
+}
+
+void UActorPoolSubsystem::Activate(AActor* Actor)
+{
+	// Put back whatever a freshly spawned instance would have
+	const AActor* Defaults = Actor->GetClass()->GetDefaultObject<AActor>();
+	Actor->SetActorHiddenInGame(Defaults->IsHidden());
+	Actor->SetActorEnableCollision(Defaults->GetActorEnableCollision());
+	Actor->SetActorTickEnabled(Defaults->PrimaryActorTick.bStartWithTickEnabled);
+	Actor->ForEachComponent(false, [](UActorComponent* Component)
+	{
+		Component->SetComponentTickEnabled(Component->PrimaryComponentTick.bStartWithTickEnabled);
+	});
+}
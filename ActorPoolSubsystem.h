@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPooledActorEvent, AActor*);
+
+USTRUCT()
+struct FActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		TArray<AActor*> FreeActors;
+};
+
+/**
+ * Hands out hidden, pre-spawned actors instead of spawning and destroying them at runtime
+ */
+UCLASS(Config = Game)
+class GARDENGAME_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Makes sure at least Count instances of Class are waiting in the pool
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+	AActor* Acquire(TSubclassOf<AActor> Class, const FVector& Location, const FRotator& Rotation);
+	template<class T>
+	T* Acquire(const FVector& Location = FVector::ZeroVector, const FRotator& Rotation = FRotator::ZeroRotator)
+	{
+		return Cast<T>(Acquire(T::StaticClass(), Location, Rotation));
+	}
+	void Release(AActor* Actor);
+
+	// Pooled actors are never spawned or destroyed again, so anything tracking them listens here
+	FOnPooledActorEvent OnActorAcquired;
+	FOnPooledActorEvent OnActorReleased;
+
+private:
+	AActor* SpawnPooledActor(TSubclassOf<AActor> Class, const FVector& Location, const FRotator& Rotation);
+	void Deactivate(AActor* Actor);
+	void Activate(AActor* Actor);
+
+	UPROPERTY()
+		TMap<UClass*, FActorPool> Pools;
+	// Instances of each class the gnomes in the level use, spawned once when the world begins play
+	UPROPERTY(Config)
+		int32 PrewarmCount = 4;
+};
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyRegistrySubsystem.h"
+#include "EnemyTurret.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GardenGameCharacterStats.h"
+#include "ActorPoolSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("EnemiesInRange"), STAT_GnomeEnemiesInRange, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("ProcessKills"), STAT_GnomeProcessKills, STATGROUP_GardenGameCharacter);
+
+void FEnemyKillQueueTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem)
+		Subsystem->ProcessKills();
+}
+
+FString FEnemyKillQueueTickFunction::DiagnosticMessage()
+{
+	return TEXT("FEnemyKillQueueTickFunction");
+}
+
+void UEnemyRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UEnemyRegistrySubsystem::OnActorSpawned));
+	ActorPool = Collection.InitializeDependency<UActorPoolSubsystem>();
+	ActorPool->OnActorAcquired.AddUObject(this, &UEnemyRegistrySubsystem::OnPooledActorAcquired);
+	ActorPool->OnActorReleased.AddUObject(this, &UEnemyRegistrySubsystem::OnPooledActorReleased);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UEnemyRegistrySubsystem::OnLevelRemovedFromWorld);
+}
+
+void UEnemyRegistrySubsystem::Deinitialize()
+{
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	if (KillQueueTickFunction.IsTickFunctionRegistered())
+		KillQueueTickFunction.UnRegisterTickFunction();
+	KillQueueTickFunction.Subsystem = nullptr;
+	Cells.Empty();
+	EnemyCells.Empty();
+	KillQueue.Empty();
+
+	Super::Deinitialize();
+}
+
+void UEnemyRegistrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Turrets placed in the level exist before the spawn handler is bound
+	for (TActorIterator<AEnemyTurret> It(&InWorld); It; ++It)
+		RegisterEnemy(*It);
+
+	// After every gnome, only enabled while kills are queued
+	KillQueueTickFunction.Subsystem = this;
+	KillQueueTickFunction.bCanEverTick = true;
+	KillQueueTickFunction.bStartWithTickEnabled = false;
+	KillQueueTickFunction.TickGroup = TG_PostPhysics;
+	KillQueueTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UEnemyRegistrySubsystem::RegisterEnemy(AEnemyTurret* Enemy)
+{
+	if (!Enemy || EnemyCells.Contains(Enemy))
+		return;
+
+	FVector Location = Enemy->GetActorLocation();
+	float Radius = Enemy->GetSimpleCollisionRadius();
+	FIntPoint Cell = GetCell(Location);
+	Cells.FindOrAdd(Cell).Add({ Enemy, Location, Radius });
+	MaxEnemyRadius = FMath::Max(MaxEnemyRadius, Radius);
+	EnemyCells.Add(Enemy, Cell);
+	Enemy->OnDestroyed.AddUniqueDynamic(this, &UEnemyRegistrySubsystem::OnEnemyDestroyed);
+}
+
+void UEnemyRegistrySubsystem::UnregisterEnemy(AEnemyTurret* Enemy)
+{
+	FIntPoint Cell;
+	if (!EnemyCells.RemoveAndCopyValue(Enemy, Cell))
+		return;
+
+	TArray<FRegisteredEnemy>& CellEnemies = Cells.FindChecked(Cell);
+	CellEnemies.RemoveAllSwap([Enemy](const FRegisteredEnemy& Entry) { return Entry.Enemy == Enemy || !Entry.Enemy.IsValid(); });
+	if (CellEnemies.Num() == 0)
+		Cells.Remove(Cell);
+	if (IsValid(Enemy))
+		Enemy->OnDestroyed.RemoveDynamic(this, &UEnemyRegistrySubsystem::OnEnemyDestroyed);
+}
+
+void UEnemyRegistrySubsystem::GetEnemiesInRange(const FVector& Center, float Range, TArray<AEnemyTurret*>& OutEnemies) const
+{
+	SCOPE_GNOME_STAT(EnemiesInRange);
+	OutEnemies.Reset();
+
+	// An enemy's collision can reach into the range from a neighbouring cell
+	float CellRange = Range + MaxEnemyRadius;
+	FIntPoint MinCell = GetCell(Center - FVector(CellRange, CellRange, 0.f));
+	FIntPoint MaxCell = GetCell(Center + FVector(CellRange, CellRange, 0.f));
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<FRegisteredEnemy>* CellEnemies = Cells.Find(FIntPoint(X, Y));
+			if (!CellEnemies)
+				continue;
+
+			for (const FRegisteredEnemy& Entry : *CellEnemies)
+			{
+				float ReachDistance = Range + Entry.Radius;
+				if (FVector::DistSquared(Center, Entry.Location) > ReachDistance * ReachDistance)
+					continue;
+
+				if (AEnemyTurret* Enemy = Entry.Enemy.Get())
+					OutEnemies.Add(Enemy);
+			}
+		}
+	}
+}
+
+void UEnemyRegistrySubsystem::QueueKill(AEnemyTurret* Enemy)
+{
+	// Out of the grid straight away so no later query this frame finds it again
+	if (!EnemyCells.Contains(Enemy))
+		return;
+
+	UnregisterEnemy(Enemy);
+	KillQueue.Add(Enemy);
+	KillQueueTickFunction.SetTickFunctionEnable(true);
+}
+
+void UEnemyRegistrySubsystem::ProcessKills()
+{
+	SCOPE_GNOME_STAT(ProcessKills);
+	KillQueueTickFunction.SetTickFunctionEnable(false);
+
+	for (const TWeakObjectPtr<AEnemyTurret>& EnemyPtr : KillQueue)
+	{
+		AEnemyTurret* Enemy = EnemyPtr.Get();
+		if (!IsValid(Enemy))
+			continue;
+
+		Enemy->KillEnemy();
+		OnEnemyKilledNative.Broadcast(Enemy);
+		OnEnemyKilled.Broadcast(Enemy);
+		// Hidden and kept for the next spawn instead of destroyed, unless KillEnemy destroyed it already
+		if (IsValid(Enemy))
+			ActorPool->Release(Enemy);
+	}
+	KillQueue.Reset();
+}
+
+FIntPoint UEnemyRegistrySubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UEnemyRegistrySubsystem::OnActorSpawned(AActor* Actor)
+{
+	RegisterEnemy(Cast<AEnemyTurret>(Actor));
+}
+
+void UEnemyRegistrySubsystem::OnEnemyDestroyed(AActor* DestroyedActor)
+{
+	UnregisterEnemy(Cast<AEnemyTurret>(DestroyedActor));
+}
+
+void UEnemyRegistrySubsystem::OnPooledActorAcquired(AActor* Actor)
+{
+	RegisterEnemy(Cast<AEnemyTurret>(Actor));
+}
+
+void UEnemyRegistrySubsystem::OnPooledActorReleased(AActor* Actor)
+{
+	UnregisterEnemy(Cast<AEnemyTurret>(Actor));
+}
+
+void UEnemyRegistrySubsystem::OnLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld())
+		return;
+
+	// A null level means the whole world is going away
+	TArray<AEnemyTurret*> Removed;
+	for (const TPair<TWeakObjectPtr<AEnemyTurret>, FIntPoint>& Pair : EnemyCells)
+	{
+		AEnemyTurret* Enemy = Pair.Key.Get();
+		if (Enemy && (!InLevel || Enemy->GetLevel() == InLevel))
+			Removed.Add(Enemy);
+	}
+	for (AEnemyTurret* Enemy : Removed)
+		UnregisterEnemy(Enemy);
+
+	// Turrets collected without OnDestroyed can no longer be looked up by pointer
+	for (auto It = EnemyCells.CreateIterator(); It; ++It)
+	{
+		if (It->Key.IsValid())
+			continue;
+
+		if (TArray<FRegisteredEnemy>* CellEnemies = Cells.Find(It->Value))
+		{
+			CellEnemies->RemoveAllSwap([](const FRegisteredEnemy& Entry) { return !Entry.Enemy.IsValid(); });
+			if (CellEnemies->Num() == 0)
+				Cells.Remove(It->Value);
+		}
+		It.RemoveCurrent();
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "EnemyRegistrySubsystem.generated.h"
+
+class AEnemyTurret;
+class UActorPoolSubsystem;
+class UEnemyRegistrySubsystem;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEnemyKilled, AEnemyTurret*, Enemy);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnemyKilledNative, AEnemyTurret*);
+
+struct FRegisteredEnemy
+{
+	TWeakObjectPtr<AEnemyTurret> Enemy;
+	FVector Location;
+	float Radius;
+};
+
+USTRUCT()
+struct FEnemyKillQueueTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UEnemyRegistrySubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FEnemyKillQueueTickFunction> : public TStructOpsTypeTraitsBase2<FEnemyKillQueueTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Keeps every enemy turret in a uniform 2D grid so range checks never touch the physics scene
+ * Turrets are treated as static: the location is cached on register, a turret that moves must be registered again
+ */
+UCLASS()
+class GARDENGAME_API UEnemyRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	void RegisterEnemy(AEnemyTurret* Enemy);
+	void UnregisterEnemy(AEnemyTurret* Enemy);
+	void GetEnemiesInRange(const FVector& Center, float Range, TArray<AEnemyTurret*>& OutEnemies) const;
+	// Killed once after every gnome has ticked, however many times it was hit this frame
+	void QueueKill(AEnemyTurret* Enemy);
+	void ProcessKills();
+
+	// Broadcast after the turret's KillEnemy, before it goes back to the pool
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+		FOnEnemyKilled OnEnemyKilled;
+	FOnEnemyKilledNative OnEnemyKilledNative;
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+	void OnActorSpawned(AActor* Actor);
+	UFUNCTION()
+		void OnEnemyDestroyed(AActor* DestroyedActor);
+	void OnPooledActorAcquired(AActor* Actor);
+	void OnPooledActorReleased(AActor* Actor);
+	void OnLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld);
+
+	// Should be around the attack range so a query only visits a handful of cells
+	float CellSize = 500.f;
+	float MaxEnemyRadius = 0.f;
+	TMap<FIntPoint, TArray<FRegisteredEnemy>> Cells;
+	// Weak so a turret streamed out or collected without OnDestroyed never leaves a dangling key
+	TMap<TWeakObjectPtr<AEnemyTurret>, FIntPoint> EnemyCells;
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle LevelRemovedHandle;
+	UActorPoolSubsystem* ActorPool;
+	FEnemyKillQueueTickFunction KillQueueTickFunction;
+	TArray<TWeakObjectPtr<AEnemyTurret>> KillQueue;
+};
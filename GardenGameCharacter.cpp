@@ -8,12 +8,50 @@
 #include "Engine/World.h"
 #include <iostream>
 #include "EnhancedInputComponent.h"
+#include "GardenGameCharacterStats.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Net/UnrealNetwork.h"
+#include "GameFramework/FloatingPawnMovement.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+// Per-state ticks
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_GnomeTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("IdleTick"), STAT_GnomeIdleTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("GroundedTick"), STAT_GnomeGroundedTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("JumpingTick"), STAT_GnomeJumpingTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("FallingTick"), STAT_GnomeFallingTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("DodgeTick"), STAT_GnomeDodgeTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("GlidingTick"), STAT_GnomeGlidingTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("GlidingBoostTick"), STAT_GnomeGlidingBoostTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("AttackTick"), STAT_GnomeAttackTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("StunTick"), STAT_GnomeStunTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("ThrowingSeedTick"), STAT_GnomeThrowingSeedTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("CheeringTick"), STAT_GnomeCheeringTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("SlidingTick"), STAT_GnomeSlidingTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("NoMovementTick"), STAT_GnomeNoMovementTick, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("NoInputTick"), STAT_GnomeNoInputTick, STATGROUP_GardenGameCharacter);
+// Collision queries
+DECLARE_CYCLE_STAT(TEXT("SweepGround"), STAT_GnomeSweepGround, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("CheckForEnemies"), STAT_GnomeCheckForEnemies, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleWallBounce"), STAT_GnomeHandleWallBounce, STATGROUP_GardenGameCharacter);
+DECLARE_CYCLE_STAT(TEXT("MoveBySimulatedVelocity"), STAT_GnomeMoveBySimulatedVelocity, STATGROUP_GardenGameCharacter);
+
+#if ENABLE_DRAW_DEBUG
+static TAutoConsoleVariable<bool> CVarGnomeDrawAttackRange(TEXT("gnome.DrawAttackRange"), false, TEXT("Draw the attack range of every gnome checking for enemies"));
+#endif
+
+// One recording or replay per world, claimed by the first locally controlled player gnome
+static TWeakObjectPtr<UWorld> InputRecordingWorld;
 
 // Sets default values
 AGardenGameCharacter::AGardenGameCharacter()
 {
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+
+	MovementComponent = CreateDefaultSubobject<UGnomeMovementComponent>(TEXT("GnomeMovement"));
 }
 
 // Called when the game starts or when spawned
@@ -24,6 +62,35 @@ void AGardenGameCharacter::BeginPlay()
 	Initialize();
 }
 
+// Called when the character is removed from the world
+void AGardenGameCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (MovementBatch)
+		MovementBatch->UnregisterCharacter(this);
+	FinishInputRecordingOrReplay();
+	if (ActorPool)
+	{
+		ActorPool->Release(ThrowVisualSpawnActorInstance);
+		ActorPool->Release(CheeringItem);
+		ActorPool->Release(StaticCamera);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called when the character is possessed or unpossessed
+void AGardenGameCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	if (!HasActorBegunPlay())
+		return;
+	if (CanRecordOrReplayInput())
+		StartInputRecordingOrReplay();
+	else if (!IsLocallyControlled() || !IsPlayerControlled())
+		FinishInputRecordingOrReplay();
+}
+
 // Called to bind functionality to input
 void AGardenGameCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -36,6 +103,9 @@ void AGardenGameCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInpu
 			Subsystem->AddMappingContext(InputMapping, 0);
 		}
 	}
+	// A replay feeds the input handlers itself, one started before this unbinds the input when it starts
+	if (InputPlayer)
+		return;
 	if (UEnhancedInputComponent* Input = CastChecked<UEnhancedInputComponent>(PlayerInputComponent))
 	{
 		Input->BindAction(JumpAction, ETriggerEvent::Started, this, &AGardenGameCharacter::JumpPressed);
@@ -52,14 +122,70 @@ void AGardenGameCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInpu
 	}
 }
 
+// Called when the movement step is blocked
+void AGardenGameCharacter::NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
+{
+	Super::NotifyHit(MyComp, Other, OtherComp, bSelfMoved, HitLocation, HitNormal, NormalImpulse, Hit);
+
+	if (CurrentState != CharacterState::Attacking || HasPendingWallBounce)
+		return;
+	if (!OtherComp || OtherComp->GetCollisionObjectType() != ECC_WorldStatic)
+		return;
+
+	// Both the angle to straight down and straight up must exceed WallBounceAngle
+	FVector ImpactDirection = (Hit.ImpactPoint - GetActorLocation()).GetSafeNormal();
+	if (FMath::Abs(ImpactDirection.Z) >= playerData->GetWallBounceMaxUpDot())
+		return;
+
+	HasPendingWallBounce = true;
+	PendingWallBounceHit = Hit;
+}
+
 // Called every frame
 void AGardenGameCharacter::Tick(float DeltaTime)
 {
+	SCOPE_GNOME_STAT(Tick);
 	Super::Tick(DeltaTime);
 
-	DeltaT = DeltaTime;
-	UpdateChachedVelocity();
+	if (InputRecorder)
+		InputRecorder->EndFrame(FApp::GetDeltaTime());
+	if (InputPlayer)
+		ReplayInputFrame();
+	ResolveDamage();
+	UpdateSimulationLOD(DeltaTime);
+	if (LODBlendPending)
+		LocationBeforeLODChange = GetActorLocation();
+
+	if (SimulationLOD == EGnomeSimulationLOD::Kinematic)
+		KinematicTick(DeltaTime);
+	else if (IsNetworkedMovement())
+		NetworkedTick(DeltaTime);
+	else if (UseFixedTimestep)
+		FixedTimestepTick(DeltaTime);
+	else
+		SimulationTick(DeltaTime);
 
+	// A result is only kept until the next frame, slower tiers would never see it
+	if (UseAsyncGroundProbe && GetActorTickInterval() <= 0.f)
+		IssueGroundProbe();
+	UpdateLODBlend(DeltaTime);
+	PublishAnimSnapshot();
+	if (CanTickSleep())
+		TickSleep();
+}
+
+void AGardenGameCharacter::SimulationTick(float DeltaTime)
+{
+	DeltaT = DeltaTime;
+	// The state this step starts from, every fixed substep and replayed move gets its own
+	if (StateHistory)
+		StateHistory->Push(CaptureStateSnapshot());
+	// The movement component has moved us since the last tick
+	ConsumeGroundProbe();
+	BeginTransformTransaction();
+
+	CharacterState TickedState = CurrentState;
+	double StateTickStart = PerfCapture ? FPlatformTime::Seconds() : 0.0;
 	switch (CurrentState)
 	{
 	case CharacterState::Idle:
@@ -109,9 +235,623 @@ void AGardenGameCharacter::Tick(float DeltaTime)
 	default:
 		break;
 	}
+	if (PerfCapture)
+		PerfCapture->RecordStateTick((uint8)TickedState, FPlatformTime::Seconds() - StateTickStart);
+	RelativeTeleport();
+	TeleportToLocation();
+	CommitTransformTransaction();
+	ApplyExternalVelocity();
+	MovementComponent->SetGroundContact(IsGroundedState() && GroundCache.bValid && GroundCache.bHit ? &GroundCache.HitResult : nullptr);
+	SimulationTime += DeltaTime;
+}
+
+void AGardenGameCharacter::FixedTimestepTick(float DeltaTime)
+{
+	float FixedStep = 1.f / FixedStepRate;
+	SimulationAccumulator += DeltaTime;
+
+	int Substeps = 0;
+	while (SimulationAccumulator >= FixedStep && Substeps < MaxSubsteps)
+	{
+		PreviousSimulatedLocation = GetActorLocation();
+		SimulationTick(FixedStep);
+		MoveBySimulatedVelocity(FixedStep);
+		SimulationAccumulator -= FixedStep;
+		Substeps++;
+	}
+	// Drop the time we could not afford to simulate rather than trying to catch up next frame
+	if (SimulationAccumulator >= FixedStep)
+		SimulationAccumulator = FMath::Fmod(SimulationAccumulator, FixedStep);
+
+	// Input callbacks between ticks expect the frame time
+	DeltaT = DeltaTime;
+	InterpolateMesh(SimulationAccumulator / FixedStep);
+}
+
+void AGardenGameCharacter::MoveBySimulatedVelocity(float StepTime)
+{
+	SCOPE_GNOME_STAT(MoveBySimulatedVelocity);
+	if (MovementComponent->Velocity.IsNearlyZero())
+		return;
+
+	MovementComponent->MoveByVelocity(StepTime);
+	InvalidateGroundCache();
+}
+
+void AGardenGameCharacter::InterpolateMesh(float Alpha)
+{
+	if (!MeshSceneComponent)
+		return;
+
+	FVector RenderLocation = FMath::Lerp(PreviousSimulatedLocation, GetActorLocation(), Alpha);
+	ApplyMeshOffset(RenderLocation - GetActorLocation() + MeshLODOffset);
+}
+
+void AGardenGameCharacter::ApplyMeshOffset(const FVector& WorldOffset)
+{
+	FVector Offset = GetActorTransform().InverseTransformVectorNoScale(WorldOffset);
+	MeshSceneComponent->SetRelativeLocation(MeshBaseRelativeLocation + Offset);
+}
+
+void AGardenGameCharacter::ResetSimulationInterpolation()
+{
+	PreviousSimulatedLocation = GetSimulatedLocation();
+	// Teleports are meant to be seen
+	MeshLODOffset = FVector::ZeroVector;
+	LODBlendPending = false;
+}
+
+FGnomeStateSnapshot AGardenGameCharacter::CaptureStateSnapshot() const
+{
+	FGnomeStateSnapshot Snapshot;
+	Snapshot.Hot = Hot;
+	Snapshot.Location = GetActorLocation();
+	Snapshot.Rotation = GetActorQuat();
+	Snapshot.Velocity = MovementComponent->Velocity;
+	Snapshot.SimulationTime = SimulationTime;
+	Snapshot.State = CurrentState;
+	return Snapshot;
+}
+
+void AGardenGameCharacter::RestoreStateSnapshot(const FGnomeStateSnapshot& Snapshot)
+{
+	CharacterState PreviousState = CurrentState;
+	bool WasSlowMotion = CurrentState == CharacterState::Dodging && Hot.DidPerfectDodge;
+	Hot = Snapshot.Hot;
+	CurrentState = Snapshot.State;
+	MovementComponent->Velocity = Snapshot.Velocity;
+	SetActorLocationAndRotation(Snapshot.Location, Snapshot.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	SimulationTime = Snapshot.SimulationTime;
+	InputBuffer.DiscardAfter(SimulationTime);
+
+	// Nothing queued for the future we just left should still happen
+	RelativeTeleportVector = FVector::ZeroVector;
+	TeleportLocation = FVector::ZeroVector;
+	ExternalVelocity = FVector::ZeroVector;
+	HasQueuedBatchedMove = false;
+	HasPendingWallBounce = false;
+	InvalidateGroundCache();
+	ResetSimulationInterpolation();
+
+	// Effects the state entries started are not part of the snapshot, match them to the restored state
+	bool IsSlowMotion = CurrentState == CharacterState::Dodging && Hot.DidPerfectDodge;
+	if (IsSlowMotion != WasSlowMotion)
+		UGameplayStatics::SetGlobalTimeDilation(GetWorld(), IsSlowMotion ? playerData->PerfectDodgeSlowMotionFactor : 1.f);
+	if (CurrentState != CharacterState::ThrowingSeed && ThrowVisualSpawnActorInstance)
+	{
+		ActorPool->Release(ThrowVisualSpawnActorInstance);
+		ThrowVisualSpawnActorInstance = nullptr;
+	}
+	else if (CurrentState == CharacterState::ThrowingSeed && !ThrowVisualSpawnActorInstance)
+		ThrowVisualSpawnActorInstance = ActorPool->Acquire(ThrowVisualSpawnActor, GetThrowLandingPoint(), GetActorRotation());
+	if (CurrentState != CharacterState::Cheering && PreviousState == CharacterState::Cheering)
+	{
+		ActorPool->Release(CheeringItem);
+		CheeringItem = nullptr;
+		if (IsPlayerControlled())
+			ReturnPlayerCameraLocation(0.f);
+	}
+	else if (CurrentState == CharacterState::Cheering && !CheeringItem)
+		CheeringItem = ActorPool->Acquire<AActor>(GetActorLocation() + (FVector::UpVector * 100.f));
+}
+
+bool AGardenGameCharacter::RewindStateHistory(int32 FramesAgo)
+{
+	const FGnomeStateSnapshot* Snapshot = StateHistory ? StateHistory->Get(FramesAgo) : nullptr;
+	if (!Snapshot)
+		return false;
+
+	WakeUp();
+	RestoreStateSnapshot(*Snapshot);
+	// The next step pushes the restored snapshot again
+	StateHistory->DiscardNewest(FramesAgo + 1);
+	return true;
+}
+
+void AGardenGameCharacter::UpdateSimulationLOD(float DeltaTime)
+{
+	if (!UseSimulationLOD)
+		return;
+
+	// A few times a second is plenty to notice the camera moving away
+	LODUpdateTimer -= DeltaTime;
+	if (LODUpdateTimer > 0.f)
+		return;
+	LODUpdateTimer = 0.25f;
+
+	EGnomeSimulationLOD NewLOD = EvaluateSimulationLOD();
+	if (NewLOD != SimulationLOD)
+		SetSimulationLOD(NewLOD);
+}
+
+EGnomeSimulationLOD AGardenGameCharacter::EvaluateSimulationLOD() const
+{
+	if (IsLocallyControlled() || IsNetworkedMovement())
+		return EGnomeSimulationLOD::Full;
+
+	float Distance = TNumericLimits<float>::Max();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
+			Distance = FMath::Min(Distance, FVector::Dist(PlayerController->PlayerCameraManager->GetCameraLocation(), GetActorLocation()));
+	}
+
+	// Has to get a bit past a threshold before getting cheaper, so hovering on it does not flicker between tiers
+	const float Hysteresis = 1.1f;
+	float ReducedDistance = ReducedLODDistance * (SimulationLOD == EGnomeSimulationLOD::Full ? Hysteresis : 1.f);
+	float KinematicDistance = KinematicLODDistance * (SimulationLOD != EGnomeSimulationLOD::Kinematic ? Hysteresis : 1.f);
+	bool IsVisible = WasRecentlyRendered(0.5f);
+	if (Distance >= KinematicDistance || (!IsVisible && Distance >= ReducedDistance))
+		return EGnomeSimulationLOD::Kinematic;
+	if (Distance >= ReducedDistance || !IsVisible)
+		return EGnomeSimulationLOD::Reduced;
+	return EGnomeSimulationLOD::Full;
+}
+
+void AGardenGameCharacter::SetSimulationLOD(EGnomeSimulationLOD NewLOD)
+{
+	SimulationLOD = NewLOD;
+	float TickRate = 0.f;
+	if (NewLOD == EGnomeSimulationLOD::Reduced)
+		TickRate = ReducedLODTickRate;
+	else if (NewLOD == EGnomeSimulationLOD::Kinematic)
+		TickRate = KinematicLODTickRate;
+	SetActorTickInterval(TickRate > 0.f ? 1.f / TickRate : 0.f);
+	if (!IsTickSleeping)
+		MovementComponent->SetComponentTickEnabled(!MovesItself());
+
+	// Whatever the first tick in the new tier snaps us by is blended out on the mesh
+	LODBlendPending = true;
+	SimulationAccumulator = 0.f;
+	InvalidateGroundCache();
+	GroundProbeHandle = FTraceHandle();
+}
+
+void AGardenGameCharacter::KinematicTick(float DeltaTime)
+{
+	DeltaT = DeltaTime;
+	// Teleports and launches still apply to gnomes nobody is looking at
 	RelativeTeleport();
 	TeleportToLocation();
-	UpdateComponentVelocity();
+	ApplyExternalVelocity();
+
+	// Coast to a stop with nothing but one sweep, airborne gnomes keep falling until they hit something
+	FVector& Velocity = MovementComponent->Velocity;
+	bool IsAirborne = !IsGroundedState();
+	if (IsAirborne)
+	{
+		FVector HorizontalVelocity = FMath::VInterpConstantTo(FVector(Velocity.X, Velocity.Y, 0.f), FVector::ZeroVector, DeltaTime, TickStats->FallHorizontalDeceleration);
+		Velocity.X = HorizontalVelocity.X;
+		Velocity.Y = HorizontalVelocity.Y;
+		HandleGravity(TickStats->FallAcceleration, TickStats->MaxFallSpeed);
+	}
+	else
+		Velocity = FMath::VInterpConstantTo(Velocity, FVector::ZeroVector, DeltaTime, TickStats->BaseMoveDeceleration);
+	if (!Velocity.IsNearlyZero())
+	{
+		FHitResult Hit;
+		SetActorLocation(GetActorLocation() + Velocity * DeltaTime, true, &Hit);
+		if (Hit.bBlockingHit)
+		{
+			Velocity = FVector::ZeroVector;
+			// Land the states the full simulation would land, anything else waits for it
+			bool CanLand = CurrentState == CharacterState::Jumping || CurrentState == CharacterState::Falling
+				|| CurrentState == CharacterState::Gliding || CurrentState == CharacterState::GlidingBoosted;
+			if (IsAirborne && CanLand && ValidGroundAngle(Hit))
+				GroundedEnter();
+		}
+	}
+	SimulationTime += DeltaTime;
+}
+
+void AGardenGameCharacter::UpdateLODBlend(float DeltaTime)
+{
+	if (!MeshSceneComponent)
+		return;
+
+	if (LODBlendPending)
+	{
+		LODBlendPending = false;
+		MeshLODOffset += LocationBeforeLODChange - GetActorLocation();
+	}
+	if (MeshLODOffset.IsZero())
+		return;
+
+	MeshLODOffset *= FMath::Clamp(1.f - DeltaTime / FMath::Max(LODBlendTime, KINDA_SMALL_NUMBER), 0.f, 1.f);
+	if (MeshLODOffset.IsNearlyZero(0.1f))
+		MeshLODOffset = FVector::ZeroVector;
+	// Fixed timestep adds it in InterpolateMesh
+	if (!UseFixedTimestep)
+		ApplyMeshOffset(MeshLODOffset);
+}
+
+void AGardenGameCharacter::PublishAnimSnapshot()
+{
+	AnimSnapshot.State = CurrentState;
+	AnimSnapshot.Speed = MovementComponent->Velocity.Size2D();
+	AnimSnapshot.VerticalSpeed = MovementComponent->Velocity.Z;
+	// Sampled once here instead of once per anim graph call
+	AnimSnapshot.AttackSpinUpAlpha = GetAttackSpinUpAlpha();
+	AnimSnapshot.SpinSpeed = FMath::Lerp(0.f, TickStats->MaxRotationSpeed, AnimSnapshot.AttackSpinUpAlpha);
+	AnimSnapshot.IsGrounded = CurrentState == CharacterState::Idle || CurrentState == CharacterState::Grounded || CurrentState == CharacterState::Sliding
+		|| CurrentState == CharacterState::ThrowingSeed || CurrentState == CharacterState::Cheering;
+	AnimSnapshot.IsGliding = CurrentState == CharacterState::Gliding || CurrentState == CharacterState::GlidingBoosted;
+	AnimSnapshot.IsDodging = CurrentState == CharacterState::Dodging;
+	AnimSnapshot.IsPerfectDodge = Hot.CurrentDodgeState == PerfectDodge;
+}
+
+void AGardenGameCharacter::BeginTransformTransaction()
+{
+	IsTransformTransactionOpen = true;
+	IsPendingTeleport = false;
+	PendingLocation = GetActorLocation();
+	PendingRotation = GetActorQuat();
+}
+
+void AGardenGameCharacter::CommitTransformTransaction()
+{
+	IsTransformTransactionOpen = false;
+	if (PendingLocation.Equals(GetActorLocation(), 0.f) && PendingRotation.Equals(GetActorQuat(), 0.f))
+		return;
+
+	// One transform propagation and overlap update for the whole tick
+	SetActorLocationAndRotation(PendingLocation, PendingRotation, false, nullptr, IsPendingTeleport ? ETeleportType::TeleportPhysics : ETeleportType::None);
+}
+
+FVector AGardenGameCharacter::GetSimulatedLocation() const
+{
+	return IsTransformTransactionOpen ? PendingLocation : GetActorLocation();
+}
+
+FVector AGardenGameCharacter::GetSimulatedForwardVector() const
+{
+	return IsTransformTransactionOpen ? PendingRotation.GetForwardVector() : GetActorForwardVector();
+}
+
+FQuat AGardenGameCharacter::GetSimulatedQuat() const
+{
+	return IsTransformTransactionOpen ? PendingRotation : GetActorQuat();
+}
+
+void AGardenGameCharacter::SetSimulatedLocation(const FVector& Location, bool IsTeleport)
+{
+	// Outside a simulation tick, e.g. from Blueprint, there is nothing to batch with
+	if (!IsTransformTransactionOpen)
+	{
+		SetActorLocation(Location, false, nullptr, IsTeleport ? ETeleportType::TeleportPhysics : ETeleportType::None);
+		return;
+	}
+	PendingLocation = Location;
+	IsPendingTeleport |= IsTeleport;
+}
+
+void AGardenGameCharacter::SetSimulatedRotation(const FRotator& Rotation)
+{
+	if (!IsTransformTransactionOpen)
+	{
+		SetActorRotation(Rotation);
+		return;
+	}
+	PendingRotation = Rotation.Quaternion();
+}
+
+bool AGardenGameCharacter::MovesItself() const
+{
+	return UseFixedTimestep || IsNetworkedMovement() || SimulationLOD == EGnomeSimulationLOD::Kinematic;
+}
+
+bool AGardenGameCharacter::IsGroundedState() const
+{
+	switch (CurrentState)
+	{
+	case CharacterState::Idle:
+	case CharacterState::Grounded:
+	case CharacterState::Attacking:
+	case CharacterState::Stunned:
+	case CharacterState::ThrowingSeed:
+	case CharacterState::Cheering:
+	case CharacterState::Sliding:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool AGardenGameCharacter::IsNetworkedMovement() const
+{
+	return UseNetworkedMovement && GetNetMode() != NM_Standalone;
+}
+
+void AGardenGameCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owning client gets corrections through ClientCorrectMoves instead
+	DOREPLIFETIME_CONDITION(AGardenGameCharacter, ProxyState, COND_SimulatedOnly);
+}
+
+void AGardenGameCharacter::NetworkedTick(float DeltaTime)
+{
+	switch (GetLocalRole())
+	{
+	case ROLE_AutonomousProxy:
+	{
+		// Predict locally with exactly what the server will be sent
+		FGnomeNetMove Move;
+		Move.SetMoveVector(Hot.moveVector);
+		Move.Buttons = NetHeldButtons | PendingPressButtons;
+		Move.SetDeltaTime(DeltaTime);
+		PendingPressButtons = 0;
+
+		ClientMoveSequence++;
+		SimulateNetMove(Move, false);
+		SavedMoves.Add({ ClientMoveSequence, Move, SimulationTime });
+		// Give up on moves the server never answered
+		if (SavedMoves.Num() > 128)
+			SavedMoves.RemoveAt(0);
+
+		TimeSinceMoveSend += DeltaTime;
+		if (TimeSinceMoveSend >= 1.f / ClientMoveSendRate)
+			SendMoves();
+		break;
+	}
+	case ROLE_Authority:
+		// Remote players are only simulated when their moves arrive, as long as they do not outrun the server
+		if (!IsLocallyControlled())
+		{
+			ClientTimeBudget = FMath::Min(ClientTimeBudget + DeltaTime, MaxClientTimeAhead);
+			break;
+		}
+		SimulationTick(DeltaTime);
+		MoveBySimulatedVelocity(DeltaTime);
+		ProxyState = GetNetState();
+		break;
+	case ROLE_SimulatedProxy:
+		// Extrapolate between server updates
+		SetActorLocation(GetActorLocation() + MovementComponent->Velocity * DeltaTime);
+		break;
+	default:
+		break;
+	}
+}
+
+void AGardenGameCharacter::SimulateNetMove(const FGnomeNetMove& Move, bool ApplyPresses)
+{
+	Hot.moveVector = Move.GetMoveVector();
+
+	// On the owning client the input handlers already recorded the presses
+	if (ApplyPresses)
+	{
+		if (Move.Buttons & JumpPress)
+		{
+			InputBuffer.Record(EBufferedInput::Jump, GetInputTime());
+			Hot.IsGlideHeld = CurrentState == CharacterState::Falling || CurrentState == CharacterState::Jumping;
+		}
+		if (Move.Buttons & DodgePress)
+			InputBuffer.Record(EBufferedInput::Dodge, GetInputTime());
+		if (Move.Buttons & AttackPress)
+			InputBuffer.Record(EBufferedInput::Attack, GetInputTime());
+		if (Move.Buttons & ThrowSeedPress)
+			InputBuffer.Record(EBufferedInput::ThrowSeed, GetInputTime());
+	}
+	Hot.IsJumpPressed = (Move.Buttons & JumpHeld) != 0;
+	if (!Hot.IsJumpPressed)
+		Hot.IsGlideHeld = false;
+	Hot.IsDodgePressed = (Move.Buttons & DodgeHeld) != 0;
+	Hot.IsAttackPressed = (Move.Buttons & AttackHeld) != 0;
+	Hot.IsThrowSeedPressed = (Move.Buttons & ThrowSeedHeld) != 0;
+
+	SimulationTick(Move.GetDeltaTime());
+	MoveBySimulatedVelocity(Move.GetDeltaTime());
+}
+
+void AGardenGameCharacter::SendMoves()
+{
+	TimeSinceMoveSend = 0.f;
+	if (SavedMoves.Num() == 0)
+		return;
+
+	// Every unacknowledged move is resent so a lost packet does not lose input
+	OutgoingMoves.Reset();
+	for (const FGnomeSavedMove& Saved : SavedMoves)
+		OutgoingMoves.Add(Saved.Move);
+	ServerMoveBatch(SavedMoves[0].Sequence, OutgoingMoves, GetActorLocation());
+}
+
+void AGardenGameCharacter::ServerMoveBatch_Implementation(uint16 FirstSequence, const TArray<FGnomeNetMove>& Moves, FVector_NetQuantize100 ClientLocation)
+{
+	// Moves the client gave up on before they arrived are lost, the client has to be put back on our state
+	bool NeedsCorrection = IsNewerGnomeMove(FirstSequence, ServerMoveSequence + 1);
+	for (int32 i = 0; i < Moves.Num(); i++)
+	{
+		uint16 Sequence = FirstSequence + i;
+		if (!IsNewerGnomeMove(Sequence, ServerMoveSequence))
+			continue;
+		ServerMoveSequence = Sequence;
+
+		// Move time is limited by the time that passed on the server
+		FGnomeNetMove Move = Moves[i];
+		float DeltaTime = FMath::Min(Move.GetDeltaTime(), ClientTimeBudget);
+		if (DeltaTime < Move.GetDeltaTime())
+			NeedsCorrection = true;
+		if (DeltaTime <= 0.f)
+			continue;
+		Move.SetDeltaTime(DeltaTime);
+		ClientTimeBudget = FMath::Max(0.f, ClientTimeBudget - Move.GetDeltaTime());
+		SimulateNetMove(Move, true);
+	}
+
+	ProxyState = GetNetState();
+	if (NeedsCorrection || FVector::DistSquared(ClientLocation, GetActorLocation()) > NetCorrectionTolerance * NetCorrectionTolerance)
+		ClientCorrectMoves(ServerMoveSequence, ProxyState);
+	else
+		ClientAckMoves(ServerMoveSequence);
+}
+
+void AGardenGameCharacter::ClientAckMoves_Implementation(uint16 Sequence)
+{
+	if (!IsNewerGnomeMove(Sequence, ClientAckedSequence))
+		return;
+
+	ClientAckedSequence = Sequence;
+	SavedMoves.RemoveAll([Sequence](const FGnomeSavedMove& Saved) { return !IsNewerGnomeMove(Saved.Sequence, Sequence); });
+}
+
+void AGardenGameCharacter::ClientCorrectMoves_Implementation(uint16 Sequence, const FGnomeNetState& State)
+{
+	// Ignore corrections that arrive after a newer answer
+	if (!IsNewerGnomeMove(Sequence, ClientAckedSequence))
+		return;
+
+	double TimeAtSequence = SimulationTime;
+	for (const FGnomeSavedMove& Saved : SavedMoves)
+	{
+		if (Saved.Sequence == Sequence)
+			TimeAtSequence = Saved.SimulationTimeAfter;
+	}
+	ClientAckMoves_Implementation(Sequence);
+
+	// Rewind to the server's state and replay the moves it has not seen yet
+	ApplyNetState(State);
+	SimulationTime = TimeAtSequence;
+	InputBuffer.DiscardAfter(TimeAtSequence);
+	// The replayed moves push their own snapshots
+	if (StateHistory)
+		StateHistory->DiscardNewest(SavedMoves.Num());
+	IsReplayingMoves = true;
+	for (FGnomeSavedMove& Saved : SavedMoves)
+	{
+		SimulateNetMove(Saved.Move, true);
+		Saved.SimulationTimeAfter = SimulationTime;
+	}
+	IsReplayingMoves = false;
+}
+
+FGnomeNetState AGardenGameCharacter::GetNetState() const
+{
+	FGnomeNetState State;
+	State.Location = GetActorLocation();
+	State.Velocity = MovementComponent->Velocity;
+	State.Yaw = FRotator::CompressAxisToShort(GetActorRotation().Yaw);
+	State.State = (uint8)CurrentState;
+	State.Flags = (Hot.DodgeConsumed ? DodgeConsumedFlag : 0) | (Hot.CoyotteAvailable ? CoyotteAvailableFlag : 0) | (Hot.IsGlideHeld ? GlideHeldFlag : 0) | (Hot.DidPerfectDodge ? PerfectDodgeFlag : 0);
+	State.DodgeState = (uint8)Hot.CurrentDodgeState;
+	State.JumpHeldTime = Hot.JumpHeldTime;
+	State.DodgeTime = Hot.DodgeTime;
+	State.AttackSpinTime = Hot.AttackSpinTime;
+	State.StunTimer = Hot.StunTimer;
+	State.TimeSinceLastWallBounce = Hot.TimeSinceLastWallBounce;
+	State.DodgeStartPos = Hot.DodgeStartPos;
+	State.DodgeEndPos = Hot.DodgeEndPos;
+	return State;
+}
+
+void AGardenGameCharacter::ApplyNetState(const FGnomeNetState& State)
+{
+	SetActorLocationAndRotation(State.Location, FRotator(0.f, FRotator::DecompressAxisFromShort(State.Yaw), 0.f), false, nullptr, ETeleportType::TeleportPhysics);
+	MovementComponent->Velocity = State.Velocity;
+	CurrentState = (CharacterState)State.State;
+	Hot.DodgeConsumed = (State.Flags & DodgeConsumedFlag) != 0;
+	Hot.CoyotteAvailable = (State.Flags & CoyotteAvailableFlag) != 0;
+	Hot.IsGlideHeld = (State.Flags & GlideHeldFlag) != 0;
+	Hot.DidPerfectDodge = (State.Flags & PerfectDodgeFlag) != 0;
+	Hot.CurrentDodgeState = (DodgeState)State.DodgeState;
+	Hot.JumpHeldTime = State.JumpHeldTime;
+	Hot.DodgeTime = State.DodgeTime;
+	Hot.AttackSpinTime = State.AttackSpinTime;
+	Hot.StunTimer = State.StunTimer;
+	Hot.TimeSinceLastWallBounce = State.TimeSinceLastWallBounce;
+	Hot.DodgeStartPos = State.DodgeStartPos;
+	Hot.DodgeEndPos = State.DodgeEndPos;
+	InvalidateGroundCache();
+	ResetSimulationInterpolation();
+}
+
+void AGardenGameCharacter::OnRep_ProxyState()
+{
+	ApplyNetState(ProxyState);
+}
+
+bool AGardenGameCharacter::CanTickSleep() const
+{
+	// Recordings hold exactly one frame per tick, and networked moves are sent every tick
+	if (InputRecorder || InputPlayer || IsNetworkedMovement())
+		return false;
+
+	switch (CurrentState)
+	{
+	case CharacterState::Idle:
+	case CharacterState::Cheering:
+	case CharacterState::Stunned:
+	case CharacterState::NoMovement:
+	case CharacterState::NoInput:
+		break;
+	default:
+		return false;
+	}
+
+	return MovementComponent->Velocity.IsNearlyZero() && Hot.moveVector.IsNearlyZero()
+		&& RelativeTeleportVector.IsZero() && TeleportLocation.IsZero() && ExternalVelocity.IsZero();
+}
+
+void AGardenGameCharacter::TickSleep()
+{
+	IsTickSleeping = true;
+	SleepStartWorldTime = GetWorld()->GetTimeSeconds();
+	SetActorTickEnabled(false);
+	MovementComponent->SetComponentTickEnabled(false);
+
+	// Timed states are woken when they would have run out
+	float SleepTime = 0.f;
+	if (CurrentState == CharacterState::Cheering)
+		SleepTime = Hot.CheeringTimeRemaining;
+	else if (CurrentState == CharacterState::Stunned)
+		SleepTime = TickStats->StunTime - Hot.StunTimer;
+	if (SleepTime > 0.f)
+		GetWorldTimerManager().SetTimer(SleepTimerHandle, this, &AGardenGameCharacter::OnSleepTimerElapsed, SleepTime);
+}
+
+void AGardenGameCharacter::WakeUp()
+{
+	if (!IsTickSleeping)
+		return;
+
+	IsTickSleeping = false;
+	GetWorldTimerManager().ClearTimer(SleepTimerHandle);
+	// Time kept passing while asleep, inputs buffered before the sleep have to age out with it
+	SimulationTime += (GetWorld()->GetTimeSeconds() - SleepStartWorldTime) * CustomTimeDilation;
+	SetActorTickEnabled(true);
+	MovementComponent->SetComponentTickEnabled(!MovesItself());
+	SimulationAccumulator = 0.f;
+}
+
+void AGardenGameCharacter::OnSleepTimerElapsed()
+{
+	// Let the next tick run the state's exit
+	Hot.CheeringTimeRemaining = 0.f;
+	Hot.StunTimer = TickStats->StunTime;
+	WakeUp();
 }
 
 void AGardenGameCharacter::Initialize()
@@ -120,68 +860,207 @@ void AGardenGameCharacter::Initialize()
 	CharacterHalfHeight = Collider->GetScaledCapsuleHalfHeight();
 	GroundCheckRadius = Collider->GetUnscaledCapsuleRadius();
 
-	MovementComponent = FindComponentByClass<UFloatingPawnMovement>();
+	// Blueprints made before UGnomeMovementComponent still carry one, it would move us a second time
+	if (UFloatingPawnMovement* FloatingMovement = FindComponentByClass<UFloatingPawnMovement>())
+		FloatingMovement->DestroyComponent();
+	// In fixed timestep and networked mode the character moves itself once per simulated step
+	MovementComponent->SetComponentTickEnabled(!MovesItself());
+	if (IsNetworkedMovement())
+		SetReplicatingMovement(false);
+	SimulationTime = 0.0;
+	NetHeldButtons = 0;
+	PendingPressButtons = 0;
+	ClientMoveSequence = 0;
+	ClientAckedSequence = 0;
+	ServerMoveSequence = 0;
+	TimeSinceMoveSend = 0.f;
+	ClientTimeBudget = MaxClientTimeAhead;
+	IsReplayingMoves = false;
+
+	MeshSceneComponent = Cast<USceneComponent>(MeshComp);
+	if (MeshSceneComponent)
+		MeshBaseRelativeLocation = MeshSceneComponent->GetRelativeLocation();
+	ResetSimulationInterpolation();
+
+	if (UseBatchedMovement && !MovesItself())
+	{
+		MovementBatch = GetWorld()->GetSubsystem<UGnomeMovementBatchSubsystem>();
+		MovementBatch->RegisterCharacter(this);
+	}
 
 	SpringArm = FindComponentByClass<USpringArmComponent>();
 	SpringArm->TargetArmLength = playerData->CameraDistance;
 	MaxHealth = playerData->StartingHealth + BonusHealth;
 
-	CurrentDodgeState = NotDodging;
+	Hot.CurrentDodgeState = NotDodging;
+	TickStats = &playerData->GetTickStats();
 
 	GroundedEnter();
 	RestoreMaxHeatlh();
+	// Possessed before BeginPlay, otherwise NotifyControllerChanged starts it
+	if (CanRecordOrReplayInput())
+		StartInputRecordingOrReplay();
 
-	StaticCamera = GetWorld()->SpawnActor<AStaticCamera>();
-}
-
-void AGardenGameCharacter::UpdateChachedVelocity()
-{
-	Velocity = MovementComponent->Velocity;
-
+	// The pool prewarms what the states show when the world begins play, so using them never hitches
+	ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	StaticCamera = ActorPool->Acquire<AStaticCamera>();
+	EnemyRegistry = GetWorld()->GetSubsystem<UEnemyRegistrySubsystem>();
+	PerfCapture = GetWorld()->GetSubsystem<UGnomePerfCaptureSubsystem>();
+	if (RecordStateHistory)
+		StateHistory = MakeUnique<FGnomeStateHistory>();
 }
 
-void AGardenGameCharacter::UpdateComponentVelocity()
+void AGardenGameCharacter::ApplyExternalVelocity()
 {
-	MovementComponent->Velocity = Velocity;
 	if (ExternalVelocity.Length() > 0)
 	{
 		MovementComponent->Velocity = ExternalVelocity;
 		ExternalVelocity = FVector::ZeroVector;
+		HasQueuedBatchedMove = false;
 	}
 }
 
-bool AGardenGameCharacter::GetGround(FHitResult& HitResult)
+bool AGardenGameCharacter::SweepGround(FHitResult& HitResult)
 {
+	SCOPE_GNOME_STAT(SweepGround);
 	if (!GetWorld())
 		return false;
-	FVector ActorLocation = GetActorLocation() + (FVector::DownVector * (CharacterHalfHeight - GroundCheckRadius));
-	FVector Start = ActorLocation;
-	FVector End = ActorLocation - FVector(0.0f, 0.0f, playerData->GroundingDistance);
+	FVector Start;
+	FVector End;
+	GetGroundSweep(GetSimulatedLocation(), Start, End);
 
 	FCollisionQueryParams TraceParams(FName(TEXT("GroundTrace")), false, this);
-	TraceParams.bIgnoreTouches = true;
 
 	FCollisionShape Sphere = FCollisionShape::MakeSphere(GroundCheckRadius);
-	bool bHit = false;
-	// Keeps searching for ground until a non-trigger collider is found
-	bool TransparentColliderFound = true;
-	while (TransparentColliderFound)
-	{
-		bHit = GetWorld()->SweepSingleByObjectType(
-			HitResult,
-			Start,
-			End,
-			FQuat::Identity,
-			FCollisionObjectQueryParams::AllObjects,
-			Sphere,
-			TraceParams
-		);
-		TransparentColliderFound = bHit && HitResult.GetComponent()->GetCollisionEnabled() == ECollisionEnabled::QueryOnly;
-		TraceParams.AddIgnoredComponent(HitResult.GetComponent());
-	}
+	INC_GNOME_COUNTER(GroundSweeps);
+	// One traversal returns every collider under us, triggers included, so pick the closest solid one
+	GroundHits.Reset();
+	GetWorld()->SweepMultiByObjectType(
+		GroundHits,
+		Start,
+		End,
+		FQuat::Identity,
+		FCollisionObjectQueryParams::AllObjects,
+		Sphere,
+		TraceParams
+	);
 
 	//DrawDebugSphere(GetWorld(), HitResult.ImpactPoint, GroundCheckRadius, 26, FColor::Red);
-	return bHit && HitResult.GetActor() != this;
+	return FindClosestGround(GroundHits, HitResult);
+}
+
+bool AGardenGameCharacter::SweepLanding(FHitResult& HitResult)
+{
+	// The ground probe already covers falls shorter than the grounding distance
+	FVector Displacement = MovementComponent->Velocity * DeltaT;
+	if (-Displacement.Z <= TickStats->GroundingDistance)
+		return false;
+
+	SCOPE_GNOME_STAT(SweepGround);
+	INC_GNOME_COUNTER(GroundSweeps);
+	FCollisionQueryParams TraceParams(FName(TEXT("LandingTrace")), false, this);
+	FCollisionResponseParams ResponseParams;
+	Collider->InitSweepCollisionParams(TraceParams, ResponseParams);
+	FVector Start = GetSimulatedLocation();
+	if (!GetWorld()->SweepSingleByChannel(HitResult, Start, Start + Displacement, GetSimulatedQuat(), Collider->GetCollisionObjectType(), Collider->GetCollisionShape(), TraceParams, ResponseParams))
+		return false;
+	// Walls and slopes too steep to stand on are left to the movement component's slide
+	if (!ValidGroundAngle(HitResult))
+		return false;
+
+	// Land at the time of impact rather than a step below it
+	SetSimulatedLocation(HitResult.Location);
+	MovementComponent->Velocity.Z = 0.f;
+	HasQueuedBatchedMove = false;
+	HitResult.Distance = 0.f;
+	GroundCache.bHit = true;
+	GroundCache.bValid = true;
+	GroundCache.HitResult = HitResult;
+	return true;
+}
+
+void AGardenGameCharacter::GetGroundSweep(const FVector& Location, FVector& Start, FVector& End) const
+{
+	Start = Location + (FVector::DownVector * (CharacterHalfHeight - GroundCheckRadius));
+	End = Start - FVector(0.0f, 0.0f, TickStats->GroundingDistance);
+}
+
+bool AGardenGameCharacter::FindClosestGround(const TArray<FHitResult>& Hits, FHitResult& HitResult) const
+{
+	const FHitResult* ClosestGround = nullptr;
+	for (const FHitResult& Hit : Hits)
+	{
+		UPrimitiveComponent* Component = Hit.GetComponent();
+		if (!Component || Hit.GetActor() == this || !CollisionEnabledHasPhysics(Component->GetCollisionEnabled()))
+			continue;
+		if (!ClosestGround || Hit.Time < ClosestGround->Time)
+			ClosestGround = &Hit;
+	}
+
+	if (!ClosestGround)
+		return false;
+
+	HitResult = *ClosestGround;
+	return true;
+}
+
+void AGardenGameCharacter::IssueGroundProbe()
+{
+	// Where the next tick will start, the movement component still has to move us this frame
+	GroundProbeLocation = GetActorLocation();
+	if (!MovesItself())
+		GroundProbeLocation += MovementComponent->Velocity * DeltaT;
+
+	FVector Start;
+	FVector End;
+	GetGroundSweep(GroundProbeLocation, Start, End);
+	FCollisionQueryParams TraceParams(FName(TEXT("GroundTrace")), false, this);
+	GroundProbeHandle = GetWorld()->AsyncSweepByObjectType(
+		EAsyncTraceType::Multi,
+		Start,
+		End,
+		FQuat::Identity,
+		FCollisionObjectQueryParams::AllObjects,
+		FCollisionShape::MakeSphere(GroundCheckRadius),
+		TraceParams
+	);
+}
+
+void AGardenGameCharacter::ConsumeGroundProbe()
+{
+	InvalidateGroundCache();
+	if (!GroundProbeHandle.IsValid())
+		return;
+
+	bool HasResult = GetWorld()->QueryTraceData(GroundProbeHandle, GroundProbeDatum);
+	GroundProbeHandle = FTraceHandle();
+	// Teleported, corrected or pushed off the prediction, let GetGround sweep from where we really are
+	FVector Offset = GetActorLocation() - GroundProbeLocation;
+	if (!HasResult || Offset.SizeSquared() > AsyncGroundProbeTolerance * AsyncGroundProbeTolerance)
+		return;
+
+	INC_DWORD_STAT(STAT_GnomeAsyncGroundProbes);
+	GroundCache.bHit = FindClosestGround(GroundProbeDatum.OutHits, GroundCache.HitResult);
+	GroundCache.bValid = true;
+	if (!GroundCache.bHit)
+		return;
+	GroundCache.HitResult.TraceStart += Offset;
+	GroundCache.HitResult.TraceEnd += Offset;
+	GroundCache.HitResult.Location += Offset;
+}
+
+bool AGardenGameCharacter::GetGround(FHitResult& HitResult)
+{
+	if (!GroundCache.bValid)
+	{
+		GroundCache.bHit = SweepGround(GroundCache.HitResult);
+		GroundCache.bValid = true;
+	}
+	else
+		INC_DWORD_STAT(STAT_GnomeGroundCacheHits);
+
+	HitResult = GroundCache.HitResult;
+	return GroundCache.bHit;
 }
 
 bool AGardenGameCharacter::GetGround()
@@ -201,17 +1080,40 @@ bool AGardenGameCharacter::GetGroundValidAngle()
 	return GetGroundValidAngle(HitResult);
 }
 
+void AGardenGameCharacter::InvalidateGroundCache()
+{
+	GroundCache.bValid = false;
+}
+
+void AGardenGameCharacter::SnapToGround(const FHitResult& GroundHit)
+{
+	if (GroundHit.Distance <= 0)
+		return;
+
+	FVector OldLocation = GetSimulatedLocation();
+	SetSimulatedLocation(FVector(OldLocation.X, OldLocation.Y, GroundHit.ImpactPoint.Z) + FVector::UpVector * CharacterHalfHeight);
+
+	// Snapping only moves us onto the surface we already hit, so keep the contact and just close the gap
+	if (!GroundCache.bValid)
+		return;
+	FVector Offset = GetSimulatedLocation() - OldLocation;
+	GroundCache.HitResult.TraceStart += Offset;
+	GroundCache.HitResult.TraceEnd += Offset;
+	GroundCache.HitResult.Location += Offset;
+	GroundCache.HitResult.Distance = 0;
+}
+
 void AGardenGameCharacter::HandleGravity(float Acceleration, float MaxFallSpeed)
 {
-	float newFallSpeed = Velocity.Z - (Acceleration * DeltaT);
-	newFallSpeed = FMath::Clamp(newFallSpeed, -MaxFallSpeed, FLT_MAX);
-	Velocity.Z = newFallSpeed;
+	GnomeMovement::FMoveState State = GetMoveState();
+	GnomeMovement::HandleGravity(State, Acceleration, MaxFallSpeed, DeltaT);
+	MovementComponent->Velocity.Z = State.Velocity.Z;
 }
 
 void AGardenGameCharacter::GroundedCheck()
 {
 	FHitResult HitResult;
-	if (!GetGround(HitResult))
+	if (!GetGround(HitResult) && !SweepLanding(HitResult))
 		return;
 
 	//GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, HitResult.GetActor()->GetName());
@@ -230,87 +1132,81 @@ void AGardenGameCharacter::StickToGround()
 		return;
 	}
 
-	FVector GroundPoint = HitResult.ImpactPoint;
-
-	if (HitResult.Distance > 0)
-		SetActorLocation(FVector(GetActorLocation().X, GetActorLocation().Y, GroundPoint.Z) + FVector::UpVector * CharacterHalfHeight);
-
-	return;
+	SnapToGround(HitResult);
 }
 
 void AGardenGameCharacter::OnGrounded()
 {
-	DodgeConsumed = false;
-	IsGlideHeld = false;
-	CoyotteAvailable = true;
+	Hot.DodgeConsumed = false;
+	Hot.IsGlideHeld = false;
+	Hot.CoyotteAvailable = true;
 	//GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, "Grounded");
 }
 
 void AGardenGameCharacter::HandleMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed)
 {
-	FVector CurrentHorizonalVelocity = FVector(Velocity.X, Velocity.Y, 0);
-	FVector TargetVelocity = moveVector * MaxSpeed;
-	float CurrentSpeed = CurrentHorizonalVelocity.Length();
-	float TargetSpeed = TargetVelocity.Length();
+	GnomeMovement::FMoveState State = GetMoveState();
+	GnomeMovement::HandleMove(State, { AccelerationSpeed, DecelerationSpeed, MaxSpeed }, DeltaT);
 
-	FVector NewHorizontalVelocity;
-	if (TargetSpeed == 0 || AccelerationSpeed == 0) //Decelerating
-		NewHorizontalVelocity = MoveVectorTowards(CurrentHorizonalVelocity, FVector::ZeroVector, DecelerationSpeed * DeltaT);
-	else //Accelerating
-		NewHorizontalVelocity = MoveVectorTowards(CurrentHorizonalVelocity, TargetVelocity, AccelerationSpeed * DeltaT);
-
-	Velocity.X = NewHorizontalVelocity.X;
-	Velocity.Y = NewHorizontalVelocity.Y;
+	MovementComponent->Velocity.X = State.Velocity.X;
+	MovementComponent->Velocity.Y = State.Velocity.Y;
 	//GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, "Move");
 }
 
-void AGardenGameCharacter::HandleGroundedMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed)
+void AGardenGameCharacter::HandleAirMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed, float FallAcceleration, float MaxFallSpeed)
 {
-	FHitResult GroundImpact;
-	if (!GetGroundValidAngle(GroundImpact))
+	if (!MovementBatch)
 	{
-		FallingEnter();
+		HandleMove(AccelerationSpeed, DecelerationSpeed, MaxSpeed);
+		HandleGravity(FallAcceleration, MaxFallSpeed);
 		return;
 	}
 
-	FVector GroundNormal = GroundImpact.ImpactNormal;
+	// The result is written back by ApplyBatchedVelocity before the movement component ticks
+	MovementBatch->QueueAirMove(this, MovementComponent->Velocity, Hot.moveVector, AccelerationSpeed, DecelerationSpeed, MaxSpeed, FallAcceleration, MaxFallSpeed, DeltaT);
+	HasQueuedBatchedMove = true;
+}
 
-	FVector RotatatedMoveVector = FVector::VectorPlaneProject(moveVector, GroundNormal);
+void AGardenGameCharacter::ApplyBatchedVelocity(const FVector& NewVelocity)
+{
+	// Dropped if something replaced our velocity after the move was queued
+	if (!HasQueuedBatchedMove)
+		return;
 
-	FVector CurrentHorizonalVelocity = Velocity;
-	FVector TargetVelocity = RotatatedMoveVector * MaxSpeed;
-	float CurrentSpeed = CurrentHorizonalVelocity.Length();
-	float TargetSpeed = TargetVelocity.Length();
+	HasQueuedBatchedMove = false;
+	MovementComponent->Velocity = NewVelocity;
+}
 
-	//DrawDebugLine(GetWorld(), GetActorLocation(), GetActorLocation() + (CurrentHorizonalVelocity *500.f), FColor::Red, false, 0.02f);
-	//DrawDebugLine(GetWorld(), GetActorLocation(), GetActorLocation() + (RotatatedMoveVector *500.f), FColor::Red, false, 0.02f);
+void AGardenGameCharacter::HandleGroundedMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed)
+{
+	FHitResult GroundImpact;
+	if (!GetGroundValidAngle(GroundImpact))
+	{
+		FallingEnter();
+		return;
+	}
 
-	FVector NewHorizontalVelocity;
-	if (TargetSpeed == 0 || AccelerationSpeed == 0) //Decelerating
-		NewHorizontalVelocity = MoveVectorTowards(CurrentHorizonalVelocity, FVector::ZeroVector, DecelerationSpeed * DeltaT);
-	else //Accelerating
-		NewHorizontalVelocity = MoveVectorTowards(CurrentHorizonalVelocity, TargetVelocity, AccelerationSpeed * DeltaT);
+	//DrawDebugLine(GetWorld(), GetActorLocation(), GetActorLocation() + (MovementComponent->Velocity *500.f), FColor::Red, false, 0.02f);
 
-	Velocity = NewHorizontalVelocity;
+	GnomeMovement::FMoveState State = GetMoveState();
+	GnomeMovement::HandleGroundedMove(State, { AccelerationSpeed, DecelerationSpeed, MaxSpeed }, ToKernelVector(GroundImpact.ImpactNormal), DeltaT);
+	MovementComponent->Velocity = FVector(State.Velocity.X, State.Velocity.Y, State.Velocity.Z);
 
 	// Stick player to ground
-	FVector GroundPoint = GroundImpact.ImpactPoint;
-
-	if (GroundImpact.Distance > 0)
-		SetActorLocation(FVector(GetActorLocation().X, GetActorLocation().Y, GroundPoint.Z) + FVector::UpVector * CharacterHalfHeight);
+	SnapToGround(GroundImpact);
 
 	//GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, "Move");
 }
 
 void AGardenGameCharacter::PointCharacterForwards()
 {
-	if (moveVector.Size() > 0)
-		SetActorRotation(FVector(Velocity.X, Velocity.Y, 0).Rotation());
+	if (Hot.moveVector.Size() > 0)
+		SetSimulatedRotation(FVector(MovementComponent->Velocity.X, MovementComponent->Velocity.Y, 0).Rotation());
 }
 
 void AGardenGameCharacter::PointCharacterTowardCamera()
 {
-	SetActorRotation(GetFlatControlRotation());
+	SetSimulatedRotation(GetFlatControlRotation());
 }
 
 FVector AGardenGameCharacter::GetForwardVector()
@@ -339,55 +1235,30 @@ FVector AGardenGameCharacter::GetRightVector()
 		return UKismetMathLibrary::GetRightVector(GetFlatControlRotation());
 }
 
-TArray<AEnemyTurret*> AGardenGameCharacter::CheckForEnemies()
+void AGardenGameCharacter::CheckForEnemies(TArray<AEnemyTurret*>& OutEnemies)
 {
-	UWorld* World = GetWorld();
-	TArray<AEnemyTurret*> OverlappingActors;
-	// Ensure the world context is valid
-	if (!World) return OverlappingActors;
+	SCOPE_GNOME_STAT(CheckForEnemies);
+	OutEnemies.Reset();
+	// Ensure the registry is valid
+	if (!EnemyRegistry || SimulationLOD != EGnomeSimulationLOD::Full) return;
 
-	DrawDebugSphere(GetWorld(), GetActorLocation(), playerData->AttackRange, 16, FColor::Red, false, 0.02f);
+#if ENABLE_DRAW_DEBUG
+	if (CVarGnomeDrawAttackRange.GetValueOnGameThread())
+		DrawDebugSphere(GetWorld(), GetSimulatedLocation(), TickStats->AttackRange, 16, FColor::Red, false, 0.02f);
+#endif
 
-	FVector SphereCenter = GetActorLocation();
-	float SphereRadius = playerData->AttackRange;
-
-	// Sphere overlap parameters
-	FCollisionShape Sphere = FCollisionShape::MakeSphere(SphereRadius);
-	TArray<FHitResult> HitResults;
-
-	// Perform the sphere overlap
-	bool bOverlapResult = World->SweepMultiByObjectType(
-		HitResults,
-		SphereCenter,
-		SphereCenter,
-		FQuat::Identity,
-		FCollisionObjectQueryParams::AllObjects,
-		Sphere
-	);
+	INC_GNOME_COUNTER(EnemyQueries);
+	EnemyRegistry->GetEnemiesInRange(GetSimulatedLocation(), TickStats->AttackRange, OutEnemies);
+}
 
-	// If the overlap found any actors
-	if (bOverlapResult)
-	{
-		for (FHitResult HitResult : HitResults)
-		{
-			AEnemyTurret* Enemy = Cast<AEnemyTurret>(HitResult.GetActor());
-			if (Enemy)
-				OverlappingActors.Add(Enemy);
-		}
-	}
-	return OverlappingActors;
+GnomeMovement::FVec3 AGardenGameCharacter::ToKernelVector(const FVector& Vector) const
+{
+	return { (float)Vector.X, (float)Vector.Y, (float)Vector.Z };
 }
 
-FVector AGardenGameCharacter::MoveVectorTowards(FVector current, FVector target, float maxDistanceDelta)
+GnomeMovement::FMoveState AGardenGameCharacter::GetMoveState() const
 {
-	FVector a = target - current;
-	float magnitude = a.Length();
-	if (magnitude <= maxDistanceDelta || magnitude == 0.f)
-	{
-		return target;
-	}
-	return current + a / magnitude * maxDistanceDelta;
-	return FVector();
+	return { ToKernelVector(MovementComponent->Velocity), ToKernelVector(Hot.moveVector) };
 }
 
 FRotator AGardenGameCharacter::GetFlatControlRotation()
@@ -399,31 +1270,54 @@ FRotator AGardenGameCharacter::GetFlatControlRotation()
 
 void AGardenGameCharacter::TakeDamage(int damage)
 {
-	if (CurrentDodgeState == DodgeState::NotDodging && !(CurrentState == CharacterState::Stunned)) {
-		Health -= damage;
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, TEXT("Player Damaged"));
+	// Resolved at the start of the next tick, the stun from one hit covers the rest of the frame's hits
+	WakeUp();
+	PendingDamage = PendingDamageHits == 0 ? damage : FMath::Max(PendingDamage, damage);
+	PendingDamageHits++;
+}
 
-		OnHealthChange.Broadcast();
+void AGardenGameCharacter::ResolveDamage()
+{
+	if (PendingDamageHits > 0)
+	{
+		if (Hot.CurrentDodgeState == DodgeState::NotDodging && !(CurrentState == CharacterState::Stunned)) {
+			Health -= PendingDamage;
+			HasPendingHealthChange = true;
 
-		StunEnter();
+			StunEnter();
 
-		if (Health <= 0)
-			Die();
+			if (Health <= 0)
+				Die();
+		}
+		else if (Hot.CurrentDodgeState == DodgeState::PerfectDodge)
+			PerfectDodgePerformed();
+		PendingDamage = 0;
+		PendingDamageHits = 0;
 	}
-	else if (CurrentDodgeState == DodgeState::PerfectDodge)
-		PerfectDodgePerformed();
+
+	if (!HasPendingHealthChange)
+		return;
+
+	HasPendingHealthChange = false;
+	float OldHealth = BroadcastHealth;
+	BroadcastHealth = Health;
+	OnHealthChangeNative.Broadcast(OldHealth, Health);
+	OnHealthChange.Broadcast(OldHealth, Health);
 }
 
 void AGardenGameCharacter::RestoreMaxHeatlh()
 {
+	WakeUp();
 	Health = MaxHealth + BonusHealth;
-	OnHealthChange.Broadcast();
+	HasPendingHealthChange = true;
 }
 
 void AGardenGameCharacter::SetBonusHealth(int Value)
 {
+	// Health itself changes on the next RestoreMaxHeatlh, listeners still want the new cap this frame
+	WakeUp();
 	BonusHealth = Value;
-	OnHealthChange.Broadcast();
+	HasPendingHealthChange = true;
 }
 
 void AGardenGameCharacter::Die()
@@ -433,11 +1327,13 @@ void AGardenGameCharacter::Die()
 
 void AGardenGameCharacter::AddRelativeTeleport(FVector Distance)
 {
+	WakeUp();
 	RelativeTeleportVector += Distance;
 }
 
 void AGardenGameCharacter::Teleport(FVector Location)
 {
+	WakeUp();
 	TeleportLocation = Location;
 }
 
@@ -446,90 +1342,75 @@ void AGardenGameCharacter::TeleportToLocation()
 	if (TeleportLocation.Length() == 0)
 		return;
 
-	SetActorLocation(TeleportLocation, false, nullptr, ETeleportType::TeleportPhysics);
-	Velocity = FVector::ZeroVector;
-	MovementComponent->Velocity = Velocity;
+	SetSimulatedLocation(TeleportLocation, true);
+	InvalidateGroundCache();
+	ResetSimulationInterpolation();
+	MovementComponent->Velocity = FVector::ZeroVector;
+	HasQueuedBatchedMove = false;
 	TeleportLocation = FVector::ZeroVector;
 }
 
 void AGardenGameCharacter::RelativeTeleport()
 {
+	if (RelativeTeleportVector.IsZero())
+		return;
+
 	//RelativeTeleportVector.Z += 1.f;
-	SetActorLocation(GetActorLocation() + RelativeTeleportVector, false);
+	SetSimulatedLocation(GetSimulatedLocation() + RelativeTeleportVector);
+	InvalidateGroundCache();
 
 	RelativeTeleportVector = FVector::ZeroVector;
 }
 
 void AGardenGameCharacter::SetVeloctiy(FVector NewVelocity)
 {
+	WakeUp();
 	ExternalVelocity = NewVelocity;
 }
 
 FVector AGardenGameCharacter::GetVeloctiy()
 {
-	return Velocity;
+	return MovementComponent->Velocity;
 }
 
 void AGardenGameCharacter::HandleWallBounce()
 {
-	TimeSinceLastWallBounce += DeltaT;
-	if (TimeSinceLastWallBounce < 0.2f)
+	SCOPE_GNOME_STAT(HandleWallBounce);
+	if (SimulationLOD != EGnomeSimulationLOD::Full)
+	{
+		HasPendingWallBounce = false;
 		return;
-	UWorld* World = GetWorld();
-	// Ensure the world context is valid
-	if (!World) return;
-
-	FVector SphereCenter = GetActorLocation();
-	float SphereRadius = playerData->WallBounceCheckDistance;
-
-	// Sphere overlap parameters
-	FCollisionShape Sphere = FCollisionShape::MakeSphere(SphereRadius);
-	TArray<FHitResult> HitResults;
-
-	// Perform the sphere overlap
-	bool bOverlapResult = World->SweepMultiByObjectType(
-		HitResults,
-		SphereCenter,
-		SphereCenter,
-		FQuat::Identity,
-		FCollisionObjectQueryParams::AllStaticObjects,
-		Sphere
-	);
-
-	if (!bOverlapResult)
+	}
+	Hot.TimeSinceLastWallBounce += DeltaT;
+	// Walls are only bounced off when last frame's movement actually ran into one (see NotifyHit)
+	bool ShouldBounce = HasPendingWallBounce && Hot.TimeSinceLastWallBounce >= 0.2f;
+	HasPendingWallBounce = false;
+	if (!ShouldBounce)
 		return;
 
-	for (FHitResult HitResult : HitResults)
-	{
-		FVector ImpactDirection = (HitResult.ImpactPoint - GetActorLocation()).GetSafeNormal();
-		float ImpactDownAngleDeg = FMath::RadiansToDegrees(FMath::Acos(FVector::DotProduct(ImpactDirection, FVector::DownVector)));
-		float ImpactUpAngleDeg = FMath::RadiansToDegrees(FMath::Acos(FVector::DotProduct(ImpactDirection, FVector::UpVector)));
-		bool ValidAngle = ImpactDownAngleDeg > playerData->WallBounceAngle && ImpactUpAngleDeg > playerData->WallBounceAngle;
-		if (ValidAngle)
-		{
-			GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Yellow, HitResult.GetActor()->GetName());
-			Velocity += HitResult.ImpactNormal * playerData->WallBounceForce;// * GetAttackSpinUpAlpha();
-			TimeSinceLastWallBounce = 0;
-			AttackSpinTime *= playerData->WallBounceSpeedReductionFactor;
-			break;
-		}
-	}
+	AActor* HitActor = PendingWallBounceHit.GetActor();
+	if (HitActor && !IsReplayingMoves)
+		GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Yellow, HitActor->GetName());
+	MovementComponent->Velocity += PendingWallBounceHit.ImpactNormal * playerData->WallBounceForce;// * GetAttackSpinUpAlpha();
+	Hot.TimeSinceLastWallBounce = 0;
+	Hot.AttackSpinTime *= playerData->WallBounceSpeedReductionFactor;
 }
 
 FVector AGardenGameCharacter::GetThrowLandingPoint()
 {
-	FVector ForwardVector = GetActorForwardVector();
+	FVector ForwardVector = GetSimulatedForwardVector();
 	FVector CameraForwardVector = UKismetMathLibrary::GetForwardVector(GetControlRotation());
 	float Dot = FVector::DotProduct(ForwardVector, CameraForwardVector);
-	FVector Offset = GetActorForwardVector() * playerData->PlantingThrowRange * Dot;
-	FVector LandPoint = GetActorLocation() + Offset;
+	FVector Offset = ForwardVector * playerData->PlantingThrowRange * Dot;
+	FVector LandPoint = GetSimulatedLocation() + Offset;
 	FHitResult HitResult;
 
-	return GetActorLocation() + Offset;
+	return GetSimulatedLocation() + Offset;
 }
 
 void AGardenGameCharacter::RemoveInputForPlayer(bool doPhysics)
 {
+	WakeUp();
 	if (doPhysics)
 		CurrentState = CharacterState::NoInput;
 	else
@@ -538,21 +1419,24 @@ void AGardenGameCharacter::RemoveInputForPlayer(bool doPhysics)
 
 void AGardenGameCharacter::ReturnInputForPlayer()
 {
+	WakeUp();
 	CurrentState = CharacterState::Falling;
 }
 
 void AGardenGameCharacter::StartCheering(AActor* DisplayActor)
 {
+	WakeUp();
 	CurrentState = CharacterState::Cheering;
-	CheeringItem = GetWorld()->SpawnActor<AActor>();
-	CheeringItem->SetActorLocation(GetActorLocation() + (FVector::UpVector * 100.f));
-	CheeringTimeRemaining = playerData->CheeringDuration;
+	CheeringItem = ActorPool->Acquire<AActor>(GetSimulatedLocation() + (FVector::UpVector * 100.f));
+	Hot.CheeringTimeRemaining = playerData->CheeringDuration;
 }
 
 void AGardenGameCharacter::StopCheering()
 {
+	WakeUp();
 	GroundedEnter();
-	CheeringItem->Destroy();
+	ActorPool->Release(CheeringItem);
+	CheeringItem = nullptr;
 }
 
 void AGardenGameCharacter::SetPlayerStaticCameraLocation(FVector Location, FVector ForwardDirection, float Speed)
@@ -567,96 +1451,281 @@ void AGardenGameCharacter::ReturnPlayerCameraLocation(float Speed)
 
 void AGardenGameCharacter::CharacterLookAt(FVector point)
 {
-	point.Z = GetActorLocation().Z;
-	FVector Direction = (point - GetActorLocation()).GetSafeNormal();
-	SetActorRotation(Direction.Rotation());
+	point.Z = GetSimulatedLocation().Z;
+	FVector Direction = (point - GetSimulatedLocation()).GetSafeNormal();
+	SetSimulatedRotation(Direction.Rotation());
 }
 
 void AGardenGameCharacter::PerfectDodgePerformed()
 {
 	UGameplayStatics::SetGlobalTimeDilation(GetWorld(), playerData->PerfectDodgeSlowMotionFactor);
-	DidPerfectDodge = true;
+	Hot.DidPerfectDodge = true;
 }
 
 bool AGardenGameCharacter::ValidGroundAngle(FHitResult HitResult)
 {
-	float GroundAngle = ((acosf(FVector::DotProduct(HitResult.ImpactNormal, FVector::UpVector))) * (180 / 3.1415926));
-	bool ValidGroundAngle = GroundAngle <= playerData->MaxGroundSlopeAngle;
-	return ValidGroundAngle;
+	return GnomeMovement::ValidGroundAngle(ToKernelVector(HitResult.ImpactNormal), TickStats->MinGroundNormalZ);
 }
 
 float AGardenGameCharacter::GetAttackSpinUpAlpha()
 {
-	float SpinAlpha = playerData->AttackSpinUpCurve.GetRichCurveConst()->Eval(AttackSpinTime / playerData->SpinUpTime);
+	float SpinAlpha = playerData->SampleAttackSpinUp(Hot.AttackSpinTime * TickStats->InvSpinUpTime);
 	FMath::Clamp(SpinAlpha, 0, 1);
 	return SpinAlpha;
 }
 
 float AGardenGameCharacter::GetSpinSpeed()
 {
-	return FMath::Lerp(0, playerData->MaxRotationSpeed, GetAttackSpinUpAlpha());
+	return FMath::Lerp(0, TickStats->MaxRotationSpeed, GetAttackSpinUpAlpha());
 }
 
-void AGardenGameCharacter::MoveInput(const FInputActionValue& Value)
+void AGardenGameCharacter::GetPooledActorClasses(TArray<UClass*>& OutClasses) const
 {
+	if (ThrowVisualSpawnActor)
+		OutClasses.AddUnique(ThrowVisualSpawnActor);
+	OutClasses.AddUnique(AActor::StaticClass());
+	OutClasses.AddUnique(AStaticCamera::StaticClass());
+}
+
+bool AGardenGameCharacter::CanRecordOrReplayInput() const
+{
+	// AI, horde and remote gnomes neither record nor follow the player's input
+	if (!IsLocallyControlled() || !IsPlayerControlled())
+		return false;
+	return !InputRecordingWorld.IsValid() || InputRecordingWorld.Get() != GetWorld();
+}
 
+void AGardenGameCharacter::StartInputRecordingOrReplay()
+{
+	FString ReplayPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("GnomeReplay="), ReplayPath))
+	{
+		InputPlayer = MakeUnique<FGnomeInputPlayer>();
+		if (!InputPlayer->Load(ReplayPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Could not load gnome input recording %s, using live input"), *ReplayPath);
+			InputPlayer.Reset();
+			return;
+		}
+
+		InputRecordingWorld = GetWorld();
+		if (UEnhancedInputComponent* Input = Cast<UEnhancedInputComponent>(InputComponent))
+			Input->ClearActionEventBindings();
+		SetActorTransform(InputPlayer->StartTransform, false, nullptr, ETeleportType::TeleportPhysics);
+		Controller->SetControlRotation(InputPlayer->StartControlRotation);
+		ResetSimulationInterpolation();
+		ReplayStateHash = 0;
+
+		// Drive the engine with the recorded frame times so world time and timers match the recording
+		float FirstDeltaTime;
+		if (InputPlayer->PeekFrameDeltaTime(FirstDeltaTime))
+		{
+			FApp::SetUseFixedTimeStep(true);
+			FApp::SetFixedDeltaTime(FirstDeltaTime);
+		}
+		return;
+	}
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("GnomeRecord="), InputRecordPath))
+	{
+		// A respawned gnome would overwrite the first recording, the world stays claimed until it ends
+		InputRecordingWorld = GetWorld();
+		InputRecorder = MakeUnique<FGnomeInputRecorder>();
+		InputRecorder->Begin(GetActorTransform(), GetControlRotation());
+	}
+}
+
+void AGardenGameCharacter::RecordInput(EGnomeRecordedInput Input, const FVector2D& Value)
+{
+	if (InputRecorder)
+		InputRecorder->RecordEvent(Input, Value);
+}
+
+void AGardenGameCharacter::ReplayInputFrame()
+{
+	float FrameDeltaTime;
+	if (!InputPlayer->ReadFrame(FrameDeltaTime, ReplayEvents))
+	{
+		FinishInputRecordingOrReplay();
+		return;
+	}
+
+	for (const FGnomeRecordedEvent& Event : ReplayEvents)
+	{
+		FInputActionValue Value(FVector2D(Event.Value));
+		switch (Event.Input)
+		{
+		case EGnomeRecordedInput::Move:
+			MoveInput(Value);
+			break;
+		case EGnomeRecordedInput::Look:
+			CameraLook(Value);
+			break;
+		case EGnomeRecordedInput::MoveCleared:
+			ClearMoveInput();
+			break;
+		case EGnomeRecordedInput::JumpPressed:
+			JumpPressed();
+			break;
+		case EGnomeRecordedInput::JumpReleased:
+			JumpReleased();
+			break;
+		case EGnomeRecordedInput::DodgePressed:
+			DodgePressed();
+			break;
+		case EGnomeRecordedInput::DodgeReleased:
+			DodgeReleased();
+			break;
+		case EGnomeRecordedInput::AttackPressed:
+			AttackPressed();
+			break;
+		case EGnomeRecordedInput::AttackReleased:
+			AttackReleased();
+			break;
+		case EGnomeRecordedInput::ThrowSeedPressed:
+			ThrowSeedPressed();
+			break;
+		case EGnomeRecordedInput::ThrowSeedReleased:
+			ThrowSeedRelease();
+			break;
+		default:
+			break;
+		}
+	}
+
+	float NextDeltaTime;
+	if (InputPlayer->PeekFrameDeltaTime(NextDeltaTime))
+		FApp::SetFixedDeltaTime(NextDeltaTime);
+
+	// Running hash of the simulated state as of this frame, compare it between builds
+	FVector Location = GetActorLocation();
+	ReplayStateHash = FCrc::MemCrc32(&Location, sizeof(Location), ReplayStateHash);
+	ReplayStateHash = FCrc::MemCrc32(&MovementComponent->Velocity, sizeof(MovementComponent->Velocity), ReplayStateHash);
+	ReplayStateHash = FCrc::MemCrc32(&CurrentState, sizeof(CurrentState), ReplayStateHash);
+}
+
+void AGardenGameCharacter::FinishInputRecordingOrReplay()
+{
+	if (InputRecorder)
+	{
+		if (InputRecorder->Save(InputRecordPath))
+			UE_LOG(LogTemp, Log, TEXT("Saved %d frames of gnome input to %s"), InputRecorder->GetNumFrames(), *InputRecordPath);
+		else
+			UE_LOG(LogTemp, Error, TEXT("Could not save gnome input recording %s"), *InputRecordPath);
+		InputRecorder.Reset();
+	}
+
+	if (InputPlayer)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Gnome replay finished, state hash %08x"), ReplayStateHash);
+		InputPlayer.Reset();
+		// The capture covers the replay, written now rather than during the exit's world teardown
+		if (PerfCapture)
+			PerfCapture->Flush();
+		FApp::SetUseFixedTimeStep(false);
+		// Headless benchmark runs end with the replay
+		if (FApp::IsUnattended())
+			FPlatformMisc::RequestExit(false);
+	}
+}
+
+double AGardenGameCharacter::GetInputTime() const
+{
+	// Simulated time rather than world time, so it rewinds with the simulation
+	return SimulationTime;
+}
+
+void AGardenGameCharacter::MoveInput(const FInputActionValue& Value)
+{
+	RecordInput(EGnomeRecordedInput::Move, Value.Get<FVector2D>());
+	WakeUp();
 	FVector LocalMovementVector = (GetForwardVector() * Value.Get<FVector2D>().Y) + (GetRightVector() * Value.Get<FVector2D>().X);
 
-	moveVector = LocalMovementVector;
-	moveVector.Normalize();
+	Hot.moveVector = LocalMovementVector;
+	Hot.moveVector.Normalize();
 }
 
 void AGardenGameCharacter::CameraLook(const FInputActionValue& Value)
 {
+	RecordInput(EGnomeRecordedInput::Look, Value.Get<FVector2D>());
 	AddControllerYawInput(Value.Get<FVector2D>().X * playerData->CameraHorizontalSensitivity * DeltaT);
 	AddControllerPitchInput(Value.Get<FVector2D>().Y * playerData->CameraVerticalSensitivity * DeltaT);
 }
 
 void AGardenGameCharacter::JumpPressed()
 {
-	IsJumpPressed = true;
-	IsGlideHeld = CurrentState == CharacterState::Falling || CurrentState == CharacterState::Jumping;
+	NetHeldButtons |= JumpHeld;
+	PendingPressButtons |= JumpPress;
+	RecordInput(EGnomeRecordedInput::JumpPressed);
+	WakeUp();
+	InputBuffer.Record(EBufferedInput::Jump, GetInputTime());
+	Hot.IsJumpPressed = true;
+	Hot.IsGlideHeld = CurrentState == CharacterState::Falling || CurrentState == CharacterState::Jumping;
 }
 
 void AGardenGameCharacter::JumpReleased()
 {
-	IsJumpPressed = false;
-	IsGlideHeld = false;
+	NetHeldButtons &= ~JumpHeld;
+	RecordInput(EGnomeRecordedInput::JumpReleased);
+	Hot.IsJumpPressed = false;
+	Hot.IsGlideHeld = false;
 }
 
 void AGardenGameCharacter::DodgePressed()
 {
-	IsDodgePressed = true;
+	NetHeldButtons |= DodgeHeld;
+	PendingPressButtons |= DodgePress;
+	RecordInput(EGnomeRecordedInput::DodgePressed);
+	WakeUp();
+	InputBuffer.Record(EBufferedInput::Dodge, GetInputTime());
+	Hot.IsDodgePressed = true;
 }
 
 void AGardenGameCharacter::DodgeReleased()
 {
-	IsDodgePressed = false;
+	NetHeldButtons &= ~DodgeHeld;
+	RecordInput(EGnomeRecordedInput::DodgeReleased);
+	Hot.IsDodgePressed = false;
 }
 
 void AGardenGameCharacter::AttackPressed()
 {
-	IsAttackPressed = true;
+	NetHeldButtons |= AttackHeld;
+	PendingPressButtons |= AttackPress;
+	RecordInput(EGnomeRecordedInput::AttackPressed);
+	WakeUp();
+	InputBuffer.Record(EBufferedInput::Attack, GetInputTime());
+	Hot.IsAttackPressed = true;
 }
 
 void AGardenGameCharacter::AttackReleased()
 {
-	IsAttackPressed = false;
+	NetHeldButtons &= ~AttackHeld;
+	RecordInput(EGnomeRecordedInput::AttackReleased);
+	Hot.IsAttackPressed = false;
 }
 
 void AGardenGameCharacter::ClearMoveInput()
 {
-	moveVector = FVector(0, 0, 0);
+	RecordInput(EGnomeRecordedInput::MoveCleared);
+	Hot.moveVector = FVector(0, 0, 0);
 }
 
 void AGardenGameCharacter::ThrowSeedPressed()
 {
-	IsThrowSeedPressed = true;
+	NetHeldButtons |= ThrowSeedHeld;
+	PendingPressButtons |= ThrowSeedPress;
+	RecordInput(EGnomeRecordedInput::ThrowSeedPressed);
+	WakeUp();
+	InputBuffer.Record(EBufferedInput::ThrowSeed, GetInputTime());
+	Hot.IsThrowSeedPressed = true;
 }
 
 void AGardenGameCharacter::ThrowSeedRelease()
 {
-	IsThrowSeedPressed = false;
+	NetHeldButtons &= ~ThrowSeedHeld;
+	RecordInput(EGnomeRecordedInput::ThrowSeedReleased);
+	Hot.IsThrowSeedPressed = false;
 }
 
 void AGardenGameCharacter::IdleEnter()
@@ -666,6 +1735,7 @@ void AGardenGameCharacter::IdleEnter()
 
 void AGardenGameCharacter::IdleTick()
 {
+	SCOPE_GNOME_STAT(IdleTick);
 }
 
 void AGardenGameCharacter::GroundedEnter()
@@ -676,7 +1746,8 @@ void AGardenGameCharacter::GroundedEnter()
 
 void AGardenGameCharacter::GroundedTick()
 {
-	HandleGroundedMove(playerData->BaseMoveAcceleration, playerData->BaseMoveDeceleration, playerData->BaseMoveSpeed);
+	SCOPE_GNOME_STAT(GroundedTick);
+	HandleGroundedMove(TickStats->BaseMoveAcceleration, TickStats->BaseMoveDeceleration, TickStats->BaseMoveSpeed);
 	PointCharacterForwards();
 	StickToGround();
 }
@@ -692,14 +1763,14 @@ void AGardenGameCharacter::CheckGroundedExitConidtions()
 void AGardenGameCharacter::EnterJump()
 {
 	CurrentState = CharacterState::Jumping;
-	JumpHeldTime = 0;
-	CoyotteAvailable = false;
+	Hot.JumpHeldTime = 0;
+	Hot.CoyotteAvailable = false;
 	//GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, "Jumped");
 }
 
 bool AGardenGameCharacter::CheckJumpEnter()
 {
-	if (IsJumpPressed)
+	if (InputBuffer.ConsumeWithin(EBufferedInput::Jump, GetInputTime(), TickStats->JumpBufferWindow))
 	{
 		EnterJump();
 		return true;
@@ -709,36 +1780,36 @@ bool AGardenGameCharacter::CheckJumpEnter()
 
 void AGardenGameCharacter::JumpingTick()
 {
-	HandleMove(playerData->FallHorizontalAcceleration, playerData->FallHorizontalDeceleration, playerData->BaseMoveSpeed);
+	SCOPE_GNOME_STAT(JumpingTick);
+	HandleMove(TickStats->FallHorizontalAcceleration, TickStats->FallHorizontalDeceleration, TickStats->BaseMoveSpeed);
 	PointCharacterForwards();
-	JumpHeldTime += DeltaT;
-	Velocity.Z = playerData->JumpForce;
+	Hot.JumpHeldTime += DeltaT;
+	MovementComponent->Velocity.Z = TickStats->JumpForce;
 	CheckDodgeEnter();
 }
 
 void AGardenGameCharacter::CheckJumpExitConidtions()
 {
-	if (!((IsJumpPressed && JumpHeldTime <= playerData->MaxJumpHoldTime) || JumpHeldTime < playerData->MinJumpHoldTime))
+	if (!((Hot.IsJumpPressed && Hot.JumpHeldTime <= TickStats->MaxJumpHoldTime) || Hot.JumpHeldTime < TickStats->MinJumpHoldTime))
 		FallingEnter();
 }
 
 void AGardenGameCharacter::FallingEnter()
 {
 	CurrentState = CharacterState::Falling;
-	IsJumpPressed = false;
-	TimeStartedFalling = 0.f;
+	Hot.IsJumpPressed = false;
+	InputBuffer.Record(EBufferedInput::LeftGround, GetInputTime());
 }
 
 void AGardenGameCharacter::FallingTick()
 {
-	HandleMove(playerData->FallHorizontalAcceleration, playerData->FallHorizontalDeceleration, playerData->BaseMoveSpeed);
+	SCOPE_GNOME_STAT(FallingTick);
+	HandleAirMove(TickStats->FallHorizontalAcceleration, TickStats->FallHorizontalDeceleration, TickStats->BaseMoveSpeed, TickStats->FallAcceleration, TickStats->MaxFallSpeed);
 	PointCharacterForwards();
-	HandleGravity(playerData->FallAcceleration, playerData->MaxFallSpeed);
 	GroundedCheck();
 
 	// Exit
-	TimeStartedFalling += DeltaT;
-	if (TimeStartedFalling < playerData->CoyotteTime && CoyotteAvailable)
+	if (Hot.CoyotteAvailable && InputBuffer.WasRecordedWithin(EBufferedInput::LeftGround, GetInputTime(), TickStats->CoyotteTime))
 		CheckJumpEnter();
 	else
 	{
@@ -749,51 +1820,60 @@ void AGardenGameCharacter::FallingTick()
 
 void AGardenGameCharacter::CheckDodgeEnter()
 {
-	if (IsDodgePressed && !DodgeConsumed)
+	if (Hot.DodgeConsumed)
+		return;
+	// A tap that was released before this tick still counts
+	bool DodgeBuffered = InputBuffer.ConsumeWithin(EBufferedInput::Dodge, GetInputTime(), TickStats->InputBufferWindow);
+	if (Hot.IsDodgePressed || DodgeBuffered)
 		DodgeEnter();
 }
 
 void AGardenGameCharacter::DodgeEnter()
 {
-	DodgeStartPos = GetActorLocation();
-	FVector DodgeDirection = moveVector.Length() > 0 ? moveVector : GetActorForwardVector();
-	DodgeEndPos = DodgeStartPos + (DodgeDirection * playerData->DodgeDistance);
-	DodgeEndPos.Z += 0.1f;
+	Hot.DodgeStartPos = GetSimulatedLocation();
+	FVector DodgeDirection = Hot.moveVector.Length() > 0 ? Hot.moveVector : GetSimulatedForwardVector();
+	Hot.DodgeEndPos = Hot.DodgeStartPos + (DodgeDirection * playerData->DodgeDistance);
+	Hot.DodgeEndPos.Z += 0.1f;
 	CurrentState = CharacterState::Dodging;
-	GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, "Dodge");
-	DodgeTime = 0.f;
-	Velocity = FVector::ZeroVector;
-	DodgeConsumed = true;
+	if (!IsReplayingMoves)
+		GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, "Dodge");
+	Hot.DodgeTime = 0.f;
+	Hot.DidPerfectDodge = false;
+	MovementComponent->Velocity = FVector::ZeroVector;
+	HasQueuedBatchedMove = false;
+	Hot.DodgeConsumed = true;
 }
 
 void AGardenGameCharacter::DodgeTick()
 {
-	DodgeTime += DeltaT;
+	SCOPE_GNOME_STAT(DodgeTick);
+	Hot.DodgeTime += DeltaT;
 
-	float DodgeAlpha = playerData->DodgeSpeedCurve.GetRichCurveConst()->Eval(DodgeTime / playerData->DodgeSpeed);
+	float DodgeAlpha = playerData->SampleDodgeSpeed(Hot.DodgeTime * TickStats->InvDodgeSpeed);
 	FMath::Clamp(DodgeAlpha, 0, 1);
-	FVector NewLocation = FMath::Lerp(DodgeStartPos, DodgeEndPos, DodgeAlpha);
+	FVector NewLocation = FMath::Lerp(Hot.DodgeStartPos, Hot.DodgeEndPos, DodgeAlpha);
 
-	if (DodgeAlpha <= playerData->PerfectDodgeWindow) {
-		CurrentDodgeState = PerfectDodge;
+	if (DodgeAlpha <= TickStats->PerfectDodgeWindow) {
+		Hot.CurrentDodgeState = PerfectDodge;
 	}
 	else
-		CurrentDodgeState = StandardDodge;
+		Hot.CurrentDodgeState = StandardDodge;
 
 
 	//SetActorLocation(NewLocation, true);
 
-	Velocity = (NewLocation - GetActorLocation()) / DeltaT;
+	MovementComponent->Velocity = (NewLocation - GetSimulatedLocation()) / DeltaT;
 	
 
 	// Exit
 	if (DodgeAlpha < 1)
 		return;
-	CurrentDodgeState = NotDodging;
-	UGameplayStatics::SetGlobalTimeDilation(GetWorld(), 1.f);
+	Hot.CurrentDodgeState = NotDodging;
+	if (!IsReplayingMoves)
+		UGameplayStatics::SetGlobalTimeDilation(GetWorld(), 1.f);
 
-	if (!DidPerfectDodge)
-		AttackSpinTime *= playerData->DodgeSlowSpinFactor;
+	if (!Hot.DidPerfectDodge)
+		Hot.AttackSpinTime *= playerData->DodgeSlowSpinFactor;
 
 	if (GetGroundValidAngle())
 		GroundedEnter();
@@ -803,23 +1883,25 @@ void AGardenGameCharacter::DodgeTick()
 
 void AGardenGameCharacter::CheckGlideEnter()
 {
-	if (IsGlideHeld && GlideUnlocked)
+	if (Hot.IsGlideHeld && GlideUnlocked)
 		GlideEnter();
 }
 
 void AGardenGameCharacter::GlideEnter()
 {
 	CurrentState = CharacterState::Gliding;
+	// The press that opened the glider should not also jump on landing
+	InputBuffer.ConsumeWithin(EBufferedInput::Jump, GetInputTime(), TickStats->JumpBufferWindow);
 }
 
 void AGardenGameCharacter::GlidingTick()
 {
-	HandleMove(playerData->GlideHorizontalAcceleration, playerData->GlideHorizontalDeceleration, playerData->GlideMoveSpeed);
-	HandleGravity(playerData->FallAcceleration, playerData->MaxGlideFallSpeed);
+	SCOPE_GNOME_STAT(GlidingTick);
+	HandleAirMove(TickStats->GlideHorizontalAcceleration, TickStats->GlideHorizontalDeceleration, TickStats->GlideMoveSpeed, TickStats->FallAcceleration, TickStats->MaxGlideFallSpeed);
 	PointCharacterForwards();
 
 	// Exit
-	if (!IsJumpPressed)
+	if (!Hot.IsJumpPressed)
 		FallingEnter();
 	CheckGlideBoostEnter();
 	GroundedCheck();
@@ -838,49 +1920,47 @@ void AGardenGameCharacter::GlideBoostEnter()
 
 void AGardenGameCharacter::GlidingBoostTick()
 {
-	HandleMove(playerData->GlideHorizontalAcceleration, playerData->GlideHorizontalDeceleration, playerData->GlideMoveSpeed);
+	SCOPE_GNOME_STAT(GlidingBoostTick);
+	HandleMove(TickStats->GlideHorizontalAcceleration, TickStats->GlideHorizontalDeceleration, TickStats->GlideMoveSpeed);
 	PointCharacterForwards();
-	Velocity += GlideBoostDirection * playerData->BoostAcceleration * DeltaT;
-	Velocity = Velocity.GetClampedToMaxSize(playerData->MaxGlideBoostSpeed);
+	MovementComponent->Velocity += GlideBoostDirection * TickStats->BoostAcceleration * DeltaT;
+	MovementComponent->Velocity = MovementComponent->Velocity.GetClampedToMaxSize(TickStats->MaxGlideBoostSpeed);
 
 	// Exit
 	if (GlideBoostDirection.Length() == 0)
 		GlideEnter();
-	if (!IsJumpPressed)
+	if (!Hot.IsJumpPressed)
 		FallingEnter();
 }
 
 void AGardenGameCharacter::CheckAttackEnter()
 {
-	if (IsAttackPressed)
+	bool AttackBuffered = InputBuffer.ConsumeWithin(EBufferedInput::Attack, GetInputTime(), TickStats->InputBufferWindow);
+	if (Hot.IsAttackPressed || AttackBuffered)
 		AttackEnter();
 }
 
 void AGardenGameCharacter::AttackEnter()
 {
 	CurrentState = CharacterState::Attacking;
-	DodgeConsumed = false;
+	Hot.DodgeConsumed = false;
+	HasPendingWallBounce = false;
 }
 
 void AGardenGameCharacter::AttackTick()
 {
-	AttackSpinTime = FMath::Clamp(AttackSpinTime + DeltaT,0, playerData->SpinUpTime);
+	SCOPE_GNOME_STAT(AttackTick);
+	Hot.AttackSpinTime = FMath::Clamp(Hot.AttackSpinTime + DeltaT,0, TickStats->SpinUpTime);
 
-	HandleGroundedMove(playerData->AttackingMoveAcceleration, playerData->AttackingMoveDeceleration, playerData->AttackingMoveSpeed);
-	HandleGravity(playerData->FallAcceleration, playerData->MaxFallSpeed);
+	HandleGroundedMove(TickStats->AttackingMoveAcceleration, TickStats->AttackingMoveDeceleration, TickStats->AttackingMoveSpeed);
+	HandleGravity(TickStats->FallAcceleration, TickStats->MaxFallSpeed);
 
-	// Try Attack
-	if (GetAttackSpinUpAlpha() >= 1)
+	// Try Attack, only the server kills so a mispredicted spin never removes a turret
+	if (HasAuthority() && GetAttackSpinUpAlpha() >= 1)
 	{
-		TArray<AEnemyTurret*> Enemeis = CheckForEnemies();
-		if (Enemeis.Num() > 0)
-		{
-			for (AEnemyTurret* Enemy : Enemeis)
-			{
-				GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, Enemy->GetName());
-				Enemy->KillEnemy();
-			}
-		}
+		CheckForEnemies(EnemiesInRange);
+		for (AEnemyTurret* Enemy : EnemiesInRange)
+			EnemyRegistry->QueueKill(Enemy);
 	}
 
 	// Wall Bounce
@@ -889,9 +1969,9 @@ void AGardenGameCharacter::AttackTick()
 	// Exit
 	CheckDodgeEnter();
 
-	if (IsAttackPressed)
+	if (Hot.IsAttackPressed)
 		return;
-	AttackSpinTime = 0.f;
+	Hot.AttackSpinTime = 0.f;
 
 	if (GetGroundValidAngle())
 		GroundedEnter();
@@ -902,56 +1982,65 @@ void AGardenGameCharacter::AttackTick()
 void AGardenGameCharacter::StunEnter()
 {
 	CurrentState = CharacterState::Stunned;
-	StunTimer = 0;
+	Hot.StunTimer = 0;
 }
 
 void AGardenGameCharacter::StunTick()
 {
-	StunTimer += DeltaT;
+	SCOPE_GNOME_STAT(StunTick);
+	Hot.StunTimer += DeltaT;
 
-	HandleGravity(playerData->FallAcceleration, playerData->MaxFallSpeed);
-	HandleGroundedMove(0, playerData->BaseMoveDeceleration, playerData->AttackingMoveSpeed);
+	HandleGravity(TickStats->FallAcceleration, TickStats->MaxFallSpeed);
+	HandleGroundedMove(0, TickStats->BaseMoveDeceleration, TickStats->AttackingMoveSpeed);
 
 	// Exit
-	if (StunTimer >= playerData->StunTime)
+	if (Hot.StunTimer >= TickStats->StunTime)
 		GroundedEnter();
 }
 
 void AGardenGameCharacter::CheckThrowingSeedEnter()
 {
-	if (IsThrowSeedPressed)
+	bool ThrowSeedBuffered = InputBuffer.ConsumeWithin(EBufferedInput::ThrowSeed, GetInputTime(), TickStats->InputBufferWindow);
+	if (Hot.IsThrowSeedPressed || ThrowSeedBuffered)
 		ThrowingSeedEnter();
 }
 
 void AGardenGameCharacter::ThrowingSeedEnter()
 {
 	CurrentState = CharacterState::ThrowingSeed;
+	// A replayed enter keeps the visual the prediction already shows
+	if (IsReplayingMoves || ThrowVisualSpawnActorInstance)
+		return;
 	FVector SpawnPoint = GetThrowLandingPoint();
-	ThrowVisualSpawnActorInstance = GetWorld()->SpawnActor<AActor>(ThrowVisualSpawnActor, SpawnPoint, GetActorRotation());
+	ThrowVisualSpawnActorInstance = ActorPool->Acquire(ThrowVisualSpawnActor, SpawnPoint, GetSimulatedForwardVector().Rotation());
 }
 
 void AGardenGameCharacter::ThrowingSeedTick()
 {
+	SCOPE_GNOME_STAT(ThrowingSeedTick);
 	PointCharacterTowardCamera();
 
-	ThrowVisualSpawnActorInstance->SetActorLocation(GetThrowLandingPoint());
+	if (ThrowVisualSpawnActorInstance)
+		ThrowVisualSpawnActorInstance->SetActorLocation(GetThrowLandingPoint());
 
 	// Exit
-	if (IsThrowSeedPressed)
+	if (Hot.IsThrowSeedPressed)
 		return;
 
-	ThrowVisualSpawnActorInstance->Destroy();
+	ActorPool->Release(ThrowVisualSpawnActorInstance);
+	ThrowVisualSpawnActorInstance = nullptr;
 
 	GroundedEnter();
 }
 
 void AGardenGameCharacter::CheeringTick()
 {
+	SCOPE_GNOME_STAT(CheeringTick);
 	HandleMove(0, 99999.f, 0.f);
 
-	CheeringTimeRemaining -= DeltaT;
+	Hot.CheeringTimeRemaining -= DeltaT;
 
-	if (CheeringTimeRemaining <= 0)
+	if (Hot.CheeringTimeRemaining <= 0)
 		CheeringExit();
 }
 
@@ -959,6 +2048,8 @@ void AGardenGameCharacter::CheeringExit()
 {
 	ReturnPlayerCameraLocation(1.f);
 	GroundedEnter();
+	ActorPool->Release(CheeringItem);
+	CheeringItem = nullptr;
 }
 
 void AGardenGameCharacter::SlidingEnter()
@@ -968,9 +2059,10 @@ void AGardenGameCharacter::SlidingEnter()
 
 void AGardenGameCharacter::SlidingTick()
 {
-	HandleMove(playerData->FallHorizontalAcceleration, playerData->FallHorizontalDeceleration, playerData->BaseMoveSpeed);
+	SCOPE_GNOME_STAT(SlidingTick);
+	HandleMove(TickStats->FallHorizontalAcceleration, TickStats->FallHorizontalDeceleration, TickStats->BaseMoveSpeed);
 	PointCharacterForwards();
-	HandleGravity(playerData->FallAcceleration, playerData->MaxFallSpeed);
+	HandleGravity(TickStats->FallAcceleration, TickStats->MaxFallSpeed);
 
 	FHitResult HitResult;
 	if (!GetGround(HitResult))
@@ -984,10 +2076,12 @@ void AGardenGameCharacter::SlidingTick()
 
 void AGardenGameCharacter::NoMovementTick()
 {
-	Velocity = FVector::ZeroVector;
+	SCOPE_GNOME_STAT(NoMovementTick);
+	MovementComponent->Velocity = FVector::ZeroVector;
 }
 
 void AGardenGameCharacter::NoInputTick()
 {
+	SCOPE_GNOME_STAT(NoInputTick);
 	HandleMove(0, 99999.f, 0.f);
 }
\ No newline at end of file
@@ -8,14 +8,24 @@
 #include "InputActionValue.h"
 #include "Components/CapsuleComponent.h"
 #include <Kismet/GameplayStatics.h>
-#include "GameFramework/FloatingPawnMovement.h"
+#include "GnomeMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Components/ArrowComponent.h"
 #include "EnemyTurret.h"
 #include "StaticCamera.h"
+#include "EnemyRegistrySubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "GnomePerfCaptureSubsystem.h"
+#include "GnomeMovementKernel.h"
+#include "GnomeMovementBatchSubsystem.h"
+#include "GnomeInputBuffer.h"
+#include "GnomeInputRecording.h"
+#include "GnomeNetMovement.h"
 #include "GardenGameCharacter.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPlayerEvent);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FPlayerHealthEvent, float, OldHealth, float, NewHealth);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FPlayerHealthNativeEvent, float /*OldHealth*/, float /*NewHealth*/);
 
 UENUM(BlueprintType)
 enum class CharacterState : uint8
@@ -36,6 +46,17 @@ enum class CharacterState : uint8
 	NoMovement
 };
 
+UENUM(BlueprintType)
+enum class EGnomeSimulationLOD : uint8
+{
+	// Whole state machine
+	Full,
+	// Lower tick rate, no wall bounces or enemy scans
+	Reduced,
+	// Moved along its velocity and gravity only, teleports and launches still apply
+	Kinematic
+};
+
 UENUM(BlueprintType)
 enum DodgeState : uint8
 {
@@ -44,6 +65,111 @@ enum DodgeState : uint8
 	StandardDodge
 };
 
+// Result of the ground sweep, reused by every ground query made during a tick
+struct FGroundContactCache
+{
+	bool bValid = false;
+	bool bHit = false;
+	FHitResult HitResult;
+};
+
+// Every plain value the state machine changes from tick to tick, kept together so it can be snapshotted with one copy.
+// Velocity lives on the movement component and CurrentState stays a UPROPERTY for Blueprint, FGnomeStateSnapshot adds them
+struct FGnomeHotState
+{
+	FVector moveVector = FVector::ZeroVector;
+	FVector DodgeStartPos = FVector::ZeroVector;
+	FVector DodgeEndPos = FVector::ZeroVector;
+	float JumpHeldTime = 0.f;
+	float DodgeTime = 0.f;
+	float AttackSpinTime = 0.f;
+	float StunTimer = 0.f;
+	float TimeSinceLastWallBounce = 0.f;
+	float CheeringTimeRemaining = 0.f;
+	DodgeState CurrentDodgeState = NotDodging;
+	bool IsJumpPressed = false;
+	bool CoyotteAvailable = false;
+	bool JumpReleasedBeforeHold = false;
+	bool IsGlideHeld = false;
+	bool IsDodgePressed = false;
+	bool DodgeConsumed = false;
+	bool DidPerfectDodge = false;
+	bool IsAttackPressed = false;
+	bool IsThrowSeedPressed = false;
+};
+static_assert(std::is_trivially_copyable_v<FGnomeHotState>, "FGnomeHotState is copied as a block");
+static_assert(sizeof(FGnomeHotState) <= 128, "FGnomeHotState should stay within two cache lines");
+
+struct FGnomeStateSnapshot
+{
+	FGnomeHotState Hot;
+	FVector Location;
+	FQuat Rotation;
+	FVector Velocity;
+	double SimulationTime;
+	CharacterState State;
+};
+
+// The last Capacity snapshots, pushing and stepping back are both O(1)
+struct FGnomeStateHistory
+{
+	static constexpr int32 Capacity = 128;
+
+	void Push(const FGnomeStateSnapshot& Snapshot)
+	{
+		Head = (Head + 1) % Capacity;
+		Snapshots[Head] = Snapshot;
+		Num = FMath::Min(Num + 1, Capacity);
+	}
+	// 0 is the newest snapshot
+	const FGnomeStateSnapshot* Get(int32 FramesAgo) const
+	{
+		if (FramesAgo < 0 || FramesAgo >= Num)
+			return nullptr;
+		return &Snapshots[(Head - FramesAgo + Capacity) % Capacity];
+	}
+	// Forgets the newest Count snapshots
+	void DiscardNewest(int32 Count)
+	{
+		Count = FMath::Clamp(Count, 0, Num);
+		Head = (Head - Count + Capacity) % Capacity;
+		Num -= Count;
+	}
+	void Clear() { Num = 0; }
+	int32 GetNum() const { return Num; }
+
+private:
+	FGnomeStateSnapshot Snapshots[Capacity];
+	int32 Head = Capacity - 1;
+	int32 Num = 0;
+};
+
+// What the animation graph needs from the character, published once per tick and safe to copy to worker threads
+USTRUCT(BlueprintType)
+struct FGnomeAnimSnapshot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+		CharacterState State = CharacterState::Idle;
+	UPROPERTY(BlueprintReadOnly)
+		float Speed = 0.f;
+	UPROPERTY(BlueprintReadOnly)
+		float VerticalSpeed = 0.f;
+	UPROPERTY(BlueprintReadOnly)
+		float AttackSpinUpAlpha = 0.f;
+	UPROPERTY(BlueprintReadOnly)
+		float SpinSpeed = 0.f;
+	UPROPERTY(BlueprintReadOnly)
+		bool IsGrounded = false;
+	UPROPERTY(BlueprintReadOnly)
+		bool IsGliding = false;
+	UPROPERTY(BlueprintReadOnly)
+		bool IsDodging = false;
+	UPROPERTY(BlueprintReadOnly)
+		bool IsPerfectDodge = false;
+};
+
 UCLASS()
 class GARDENGAME_API AGardenGameCharacter : public APawn
 {
@@ -56,18 +182,28 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	// Called when the character is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	// Called when the character is possessed or unpossessed
+	virtual void NotifyControllerChanged() override;
+
+	// Called when the movement step is blocked
+	virtual void NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
 public:
 	// Components
 	UCapsuleComponent* Collider;
-	UFloatingPawnMovement* MovementComponent;
+	UPROPERTY(VisibleAnywhere)
+		UGnomeMovementComponent* MovementComponent;
 	USpringArmComponent* SpringArm;
 	UPROPERTY(EditDefaultsOnly)
 		UActorComponent* MeshComp;
@@ -78,41 +214,115 @@ public:
 	// General
 	float GroundCheckRadius;
 	float DeltaT;
-	FVector moveVector;
 	float CharacterHalfHeight;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 		CharacterState CurrentState;
-	FVector Velocity;
+	FGnomeHotState Hot;
+	// Snapshot after every tick for rewinding and debugging
+	UPROPERTY(EditAnywhere)
+		bool RecordStateHistory;
+	TUniquePtr<FGnomeStateHistory> StateHistory;
 	FVector RelativeTeleportVector;
 	FVector TeleportLocation;
 	FVector ExternalVelocity;
+	// Everything the states move during a simulation tick is written to the actor once at the end
+	bool IsTransformTransactionOpen;
+	bool IsPendingTeleport;
+	FVector PendingLocation;
+	FQuat PendingRotation;
+	FGnomeInputBuffer InputBuffer;
+	FGroundContactCache GroundCache;
+	FGnomeAnimSnapshot AnimSnapshot;
+	TArray<FHitResult> GroundHits;
+	// Sweep for the next tick's ground while the physics scene is idle, used when we end up where it was issued
+	UPROPERTY(EditAnywhere)
+		bool UseAsyncGroundProbe;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseAsyncGroundProbe", ClampMin = "0"))
+		float AsyncGroundProbeTolerance = 1.f;
+	FTraceHandle GroundProbeHandle;
+	FTraceDatum GroundProbeDatum;
+	FVector GroundProbeLocation;
+
+	// Simulation
+	UPROPERTY(EditAnywhere)
+		bool UseFixedTimestep;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseFixedTimestep", ClampMin = "1"))
+		float FixedStepRate = 60.f;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseFixedTimestep", ClampMin = "1"))
+		int MaxSubsteps = 4;
+	float SimulationAccumulator;
+	FVector PreviousSimulatedLocation;
+	USceneComponent* MeshSceneComponent;
+	FVector MeshBaseRelativeLocation;
+	// Integrate airborne velocity together with the other gnomes, not used in fixed timestep mode
+	UPROPERTY(EditAnywhere)
+		bool UseBatchedMovement;
+	UGnomeMovementBatchSubsystem* MovementBatch;
+	bool HasQueuedBatchedMove;
+	// Passive states stop ticking until something wakes the character
+	bool IsTickSleeping;
+	FTimerHandle SleepTimerHandle;
+	double SleepStartWorldTime;
+	// Simulation LOD, gnomes that are not locally controlled get cheaper with distance from every local view
+	UPROPERTY(EditAnywhere)
+		bool UseSimulationLOD;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseSimulationLOD", ClampMin = "0"))
+		float ReducedLODDistance = 2000.f;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseSimulationLOD", ClampMin = "0"))
+		float KinematicLODDistance = 5000.f;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseSimulationLOD", ClampMin = "1"))
+		float ReducedLODTickRate = 20.f;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseSimulationLOD", ClampMin = "1"))
+		float KinematicLODTickRate = 5.f;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseSimulationLOD", ClampMin = "0"))
+		float LODBlendTime = 0.25f;
+	UPROPERTY(VisibleInstanceOnly)
+		EGnomeSimulationLOD SimulationLOD;
+	float LODUpdateTimer;
+	bool LODBlendPending;
+	FVector LocationBeforeLODChange;
+	FVector MeshLODOffset;
+
+	// Recording and replay, started with -GnomeRecord=<file> or -GnomeReplay=<file>
+	TUniquePtr<FGnomeInputRecorder> InputRecorder;
+	TUniquePtr<FGnomeInputPlayer> InputPlayer;
+	FString InputRecordPath;
+	TArray<FGnomeRecordedEvent> ReplayEvents;
+	uint32 ReplayStateHash;
 
-	// Jumping
-	bool IsJumpPressed;
-	float JumpHeldTime;
-	float TimeStartedFalling;
-	bool CoyotteAvailable;
+	// Networking, clients predict their own moves and the server corrects them
+	UPROPERTY(EditAnywhere)
+		bool UseNetworkedMovement;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseNetworkedMovement", ClampMin = "1"))
+		float ClientMoveSendRate = 30.f;
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseNetworkedMovement"))
+		float NetCorrectionTolerance = 5.f;
+	// How far the server lets a client's move time run ahead of its own clock, in seconds
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "UseNetworkedMovement", ClampMin = "0"))
+		float MaxClientTimeAhead = 0.25f;
+	UPROPERTY(ReplicatedUsing = OnRep_ProxyState)
+		FGnomeNetState ProxyState;
+	double SimulationTime;
+	uint8 NetHeldButtons;
+	uint8 PendingPressButtons;
+	uint16 ClientMoveSequence;
+	uint16 ClientAckedSequence;
+	uint16 ServerMoveSequence;
+	float TimeSinceMoveSend;
+	TArray<FGnomeSavedMove> SavedMoves;
+	TArray<FGnomeNetMove> OutgoingMoves;
+	// Server side, move time the owning client may still use
+	float ClientTimeBudget;
+	// Set while a correction replays saved moves, one-off effects already happened when they were predicted
+	bool IsReplayingMoves;
 
 	// Gliding
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 		FVector GlideBoostDirection;
-	bool JumpReleasedBeforeHold;
-	bool IsGlideHeld;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 		bool GlideUnlocked;
 
-	// Dodge
-	bool IsDodgePressed;
-	FVector DodgeStartPos;
-	FVector DodgeEndPos;
-	float DodgeTime;
-	bool DodgeConsumed;
-	DodgeState CurrentDodgeState;
-	bool DidPerfectDodge;
-
 	// Combat
-	bool IsAttackPressed;
-	float AttackSpinTime;
 	UPROPERTY(BlueprintReadOnly)
 		float Health;
 	float BonusHealth;
@@ -127,15 +337,21 @@ public:
 		bool InCombat;
 	UPROPERTY(BlueprintReadWrite)
 		FVector CombatCameraDirection;
+	// Broadcast at most once per frame, after the frame's damage has been resolved.
+	// Used to be a parameterless FPlayerEvent, Blueprint bindings from before need their event refreshed
 	UPROPERTY(BlueprintAssignable, Category = "Events")
-		FPlayerEvent OnHealthChange;
-	float TimeSinceLastWallBounce;
-
-	// Stun
-	float StunTimer;
+		FPlayerHealthEvent OnHealthChange;
+	FPlayerHealthNativeEvent OnHealthChangeNative;
+	int PendingDamage;
+	int PendingDamageHits;
+	bool HasPendingHealthChange;
+	float BroadcastHealth;
+	bool HasPendingWallBounce;
+	FHitResult PendingWallBounceHit;
+	UEnemyRegistrySubsystem* EnemyRegistry;
+	TArray<AEnemyTurret*> EnemiesInRange;
 
 	// Planting
-	bool IsThrowSeedPressed;
 	int CurrentThrowAmmoIndex;
 	UPROPERTY(EditDefaultsOnly)
 		TSubclassOf<AActor>ThrowVisualSpawnActor;
@@ -143,11 +359,14 @@ public:
 
 	//Cheering
 	AActor* CheeringItem;
-	float CheeringTimeRemaining;
+	UActorPoolSubsystem* ActorPool;
+	UGnomePerfCaptureSubsystem* PerfCapture;
 
 public:
 	UPROPERTY(EditDefaultsOnly)
 		UPlayerStatsDataAsset* playerData;
+	// Everything the state ticks read from playerData
+	const FPlayerTickStats* TickStats;
 
 	UPROPERTY(EditAnywhere)
 		class UInputMappingContext* InputMapping;
@@ -170,12 +389,69 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 		float GetSpinSpeed();
 
+	void ApplyBatchedVelocity(const FVector& NewVelocity);
+	// Undoes the last FramesAgo + 1 simulation steps, needs RecordStateHistory
+	UFUNCTION(BlueprintCallable)
+		bool RewindStateHistory(int32 FramesAgo);
+	const FGnomeAnimSnapshot& GetAnimSnapshot() const { return AnimSnapshot; }
+	// Everything the states take from the actor pool
+	void GetPooledActorClasses(TArray<UClass*>& OutClasses) const;
+
 private:
 	void Initialize();
-	void UpdateChachedVelocity();
-	void UpdateComponentVelocity();
+	void SimulationTick(float DeltaTime);
+	void FixedTimestepTick(float DeltaTime);
+	void MoveBySimulatedVelocity(float StepTime);
+	void InterpolateMesh(float Alpha);
+	void ResetSimulationInterpolation();
+	void PublishAnimSnapshot();
+	FGnomeStateSnapshot CaptureStateSnapshot() const;
+	void RestoreStateSnapshot(const FGnomeStateSnapshot& Snapshot);
+	void UpdateSimulationLOD(float DeltaTime);
+	EGnomeSimulationLOD EvaluateSimulationLOD() const;
+	void SetSimulationLOD(EGnomeSimulationLOD NewLOD);
+	void KinematicTick(float DeltaTime);
+	void UpdateLODBlend(float DeltaTime);
+	void ApplyMeshOffset(const FVector& WorldOffset);
+	void BeginTransformTransaction();
+	void CommitTransformTransaction();
+	FVector GetSimulatedLocation() const;
+	FVector GetSimulatedForwardVector() const;
+	FQuat GetSimulatedQuat() const;
+	void SetSimulatedLocation(const FVector& Location, bool IsTeleport = false);
+	void SetSimulatedRotation(const FRotator& Rotation);
+	bool MovesItself() const;
+	bool IsNetworkedMovement() const;
+	// States that move along the floor rather than through the air
+	bool IsGroundedState() const;
+	void NetworkedTick(float DeltaTime);
+	void SimulateNetMove(const FGnomeNetMove& Move, bool ApplyPresses);
+	void SendMoves();
+	FGnomeNetState GetNetState() const;
+	void ApplyNetState(const FGnomeNetState& State);
+	UFUNCTION(Server, Unreliable)
+		void ServerMoveBatch(uint16 FirstSequence, const TArray<FGnomeNetMove>& Moves, FVector_NetQuantize100 ClientLocation);
+	UFUNCTION(Client, Unreliable)
+		void ClientAckMoves(uint16 Sequence);
+	UFUNCTION(Client, Unreliable)
+		void ClientCorrectMoves(uint16 Sequence, const FGnomeNetState& State);
+	UFUNCTION()
+		void OnRep_ProxyState();
+	bool CanTickSleep() const;
+	void TickSleep();
+	void WakeUp();
+	void OnSleepTimerElapsed();
+	void ApplyExternalVelocity();
+	bool SweepGround(FHitResult& HitResult);
+	void GetGroundSweep(const FVector& Location, FVector& Start, FVector& End) const;
+	bool SweepLanding(FHitResult& HitResult);
+	bool FindClosestGround(const TArray<FHitResult>& Hits, FHitResult& HitResult) const;
+	void IssueGroundProbe();
+	void ConsumeGroundProbe();
 	bool GetGround(FHitResult& HitResult);
 	bool GetGround();
+	void InvalidateGroundCache();
+	void SnapToGround(const FHitResult& GroundHit);
 	bool GetGroundValidAngle(FHitResult& HitResult);
 	bool GetGroundValidAngle();
 	void HandleGravity(float Acceleration, float MaxFallSpeed);
@@ -183,13 +459,15 @@ private:
 	void StickToGround();
 	void OnGrounded();
 	void HandleMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed);
+	void HandleAirMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed, float FallAcceleration, float MaxFallSpeed);
 	void HandleGroundedMove(float AccelerationSpeed, float DecelerationSpeed, float MaxSpeed);
 	void PointCharacterForwards();
 	void PointCharacterTowardCamera();
 	FVector GetForwardVector();
 	FVector GetRightVector();
-	TArray<AEnemyTurret*> CheckForEnemies();
-	FVector MoveVectorTowards(FVector current, FVector target, float maxDistanceDelta);
+	void CheckForEnemies(TArray<AEnemyTurret*>& OutEnemies);
+	GnomeMovement::FVec3 ToKernelVector(const FVector& Vector) const;
+	GnomeMovement::FMoveState GetMoveState() const;
 	FRotator GetFlatControlRotation();
 	UFUNCTION(BlueprintCallable)
 		void TakeDamage(int damage);
@@ -198,6 +476,7 @@ private:
 	UFUNCTION(BlueprintCallable)
 		void SetBonusHealth(int Value);
 	void Die();
+	void ResolveDamage();
 	UFUNCTION(BlueprintCallable)
 		void AddRelativeTeleport(FVector Distance);
 	UFUNCTION(BlueprintCallable)
@@ -227,7 +506,15 @@ private:
 	void PerfectDodgePerformed();
 	bool ValidGroundAngle(FHitResult HitResult);
 
+	// Recording
+	bool CanRecordOrReplayInput() const;
+	void StartInputRecordingOrReplay();
+	void RecordInput(EGnomeRecordedInput Input, const FVector2D& Value = FVector2D::ZeroVector);
+	void ReplayInputFrame();
+	void FinishInputRecordingOrReplay();
+
 	// Input
+	double GetInputTime() const;
 	void MoveInput(const FInputActionValue& Value);
 	void CameraLook(const FInputActionValue& Value);
 	void JumpPressed();
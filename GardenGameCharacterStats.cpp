@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GardenGameCharacterStats.h"
+
+DEFINE_STAT(STAT_GnomeGroundSweeps);
+DEFINE_STAT(STAT_GnomeGroundCacheHits);
+DEFINE_STAT(STAT_GnomeAsyncGroundProbes);
+DEFINE_STAT(STAT_GnomeEnemyQueries);
+DEFINE_STAT(STAT_GnomeMovementSweeps);
+
+FGnomeQueryCounters GGnomeQueryCounters;
+
+#if !UE_BUILD_SHIPPING
+UE_TRACE_CHANNEL_DEFINE(GnomeCharacterChannel);
+#endif
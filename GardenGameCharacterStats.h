@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include <atomic>
+
+// "stat GardenGameCharacter" in game, or the GnomeCharacter channel in Unreal Insights
+DECLARE_STATS_GROUP(TEXT("GardenGameCharacter"), STATGROUP_GardenGameCharacter, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ground Sweeps"), STAT_GnomeGroundSweeps, STATGROUP_GardenGameCharacter, GARDENGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ground Cache Hits"), STAT_GnomeGroundCacheHits, STATGROUP_GardenGameCharacter, GARDENGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Ground Probes Used"), STAT_GnomeAsyncGroundProbes, STATGROUP_GardenGameCharacter, GARDENGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy Range Queries"), STAT_GnomeEnemyQueries, STATGROUP_GardenGameCharacter, GARDENGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Movement Sweeps"), STAT_GnomeMovementSweeps, STATGROUP_GardenGameCharacter, GARDENGAME_API);
+
+// The same counts as plain integers, stat values cannot be read back from game code (see UGnomePerfCaptureSubsystem).
+// Atomic so a query made off the game thread is still counted, and read with exchange so none are lost between read and reset
+struct FGnomeQueryCounters
+{
+	std::atomic<uint32> GroundSweeps{ 0 };
+	std::atomic<uint32> EnemyQueries{ 0 };
+	std::atomic<uint32> MovementSweeps{ 0 };
+
+	void Reset()
+	{
+		GroundSweeps.store(0, std::memory_order_relaxed);
+		EnemyQueries.store(0, std::memory_order_relaxed);
+		MovementSweeps.store(0, std::memory_order_relaxed);
+	}
+};
+extern GARDENGAME_API FGnomeQueryCounters GGnomeQueryCounters;
+
+#define INC_GNOME_COUNTER(Name) \
+	INC_DWORD_STAT(STAT_Gnome##Name); \
+	GGnomeQueryCounters.Name.fetch_add(1, std::memory_order_relaxed)
+
+#if !UE_BUILD_SHIPPING
+UE_TRACE_CHANNEL_EXTERN(GnomeCharacterChannel, GARDENGAME_API);
+
+// Cycle counter plus a matching Insights event, Name needs a DECLARE_CYCLE_STAT of STAT_Gnome##Name
+#define SCOPE_GNOME_STAT(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Gnome##Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Gnome##Name, GnomeCharacterChannel)
+#else
+#define SCOPE_GNOME_STAT(Name)
+#endif
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeAnimInstance.h"
+
+void FGnomeAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	if (const AGardenGameCharacter* Gnome = Cast<AGardenGameCharacter>(InAnimInstance->TryGetPawnOwner()))
+		Snapshot = Gnome->GetAnimSnapshot();
+}
+
+const FGnomeAnimSnapshot& UGnomeAnimInstance::GetGnomeSnapshot() const
+{
+	return GetProxyOnAnyThread<FGnomeAnimInstanceProxy>().Snapshot;
+}
+
+CharacterState UGnomeAnimInstance::GetGnomeState() const
+{
+	return GetGnomeSnapshot().State;
+}
+
+float UGnomeAnimInstance::GetGnomeSpinSpeed() const
+{
+	return GetGnomeSnapshot().SpinSpeed;
+}
+
+float UGnomeAnimInstance::GetGnomeAttackSpinUpAlpha() const
+{
+	return GetGnomeSnapshot().AttackSpinUpAlpha;
+}
+
+FAnimInstanceProxy* UGnomeAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FGnomeAnimInstanceProxy(this);
+}
+
+void UGnomeAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy)
+{
+	delete InProxy;
+}
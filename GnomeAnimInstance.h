@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "GardenGameCharacter.h"
+#include "GnomeAnimInstance.generated.h"
+
+USTRUCT()
+struct FGnomeAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FGnomeAnimInstanceProxy() = default;
+	FGnomeAnimInstanceProxy(UAnimInstance* InAnimInstance) : FAnimInstanceProxy(InAnimInstance) {}
+
+	// Game thread, copies the character's snapshot before the worker update starts
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+
+	FGnomeAnimSnapshot Snapshot;
+};
+
+/**
+ * Anim instance for the gnome that only reads the character through a copied snapshot,
+ * so the graph can run with multithreaded animation update
+ */
+UCLASS(Transient, Blueprintable)
+class GARDENGAME_API UGnomeAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, meta = (BlueprintThreadSafe))
+		const FGnomeAnimSnapshot& GetGnomeSnapshot() const;
+	UFUNCTION(BlueprintPure, meta = (BlueprintThreadSafe))
+		CharacterState GetGnomeState() const;
+	UFUNCTION(BlueprintPure, meta = (BlueprintThreadSafe))
+		float GetGnomeSpinSpeed() const;
+	UFUNCTION(BlueprintPure, meta = (BlueprintThreadSafe))
+		float GetGnomeAttackSpinUpAlpha() const;
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeInputBuffer.h"
+
+void FGnomeInputBuffer::Record(EBufferedInput Input, double Time)
+{
+	Events[Head] = { Time, 0.0, Input, false };
+	Head = (Head + 1) % Capacity;
+	Num = FMath::Min(Num + 1, Capacity);
+}
+
+bool FGnomeInputBuffer::WasRecordedWithin(EBufferedInput Input, double Now, float Window) const
+{
+	return FindWithin(Input, Now, Window) != INDEX_NONE;
+}
+
+bool FGnomeInputBuffer::ConsumeWithin(EBufferedInput Input, double Now, float Window)
+{
+	int32 Index = FindWithin(Input, Now, Window);
+	if (Index == INDEX_NONE)
+		return false;
+
+	Events[Index].Consumed = true;
+	Events[Index].ConsumedTime = Now;
+	return true;
+}
+
+void FGnomeInputBuffer::DiscardAfter(double Time)
+{
+	while (Num > 0)
+	{
+		int32 Newest = (Head - 1 + Capacity) % Capacity;
+		if (Events[Newest].Time <= Time)
+			break;
+		Head = Newest;
+		Num--;
+	}
+
+	// The step that consumed these starts at or after Time, so it will run again
+	for (int32 i = 1; i <= Num; i++)
+	{
+		FEvent& Event = Events[(Head - i + Capacity) % Capacity];
+		if (Event.Consumed && Event.ConsumedTime >= Time)
+			Event.Consumed = false;
+	}
+}
+
+void FGnomeInputBuffer::Clear()
+{
+	Head = 0;
+	Num = 0;
+}
+
+int32 FGnomeInputBuffer::FindWithin(EBufferedInput Input, double Now, float Window) const
+{
+	// Newest first, events are recorded in time order so we can stop at the first one outside the window
+	for (int32 i = 1; i <= Num; i++)
+	{
+		int32 Index = (Head - i + Capacity) % Capacity;
+		const FEvent& Event = Events[Index];
+		if (Now - Event.Time > Window)
+			break;
+		if (Event.Input == Input && !Event.Consumed)
+			return Index;
+	}
+	return INDEX_NONE;
+}
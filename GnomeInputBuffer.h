@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EBufferedInput : uint8
+{
+	Jump,
+	Dodge,
+	Attack,
+	ThrowSeed,
+	LeftGround
+};
+
+/**
+ * Ring buffer of timestamped input presses and movement events, so states can ask
+ * whether something happened within a window instead of only seeing what is held this tick
+ */
+struct FGnomeInputBuffer
+{
+	static constexpr int32 Capacity = 16;
+
+	void Record(EBufferedInput Input, double Time);
+	bool WasRecordedWithin(EBufferedInput Input, double Now, float Window) const;
+	// Like WasRecordedWithin, but the matching event can only be used once
+	bool ConsumeWithin(EBufferedInput Input, double Now, float Window);
+	// Forgets everything recorded after Time and makes events consumed from Time on usable again, used when rewinding the simulation
+	void DiscardAfter(double Time);
+	void Clear();
+
+private:
+	struct FEvent
+	{
+		double Time;
+		double ConsumedTime;
+		EBufferedInput Input;
+		bool Consumed;
+	};
+
+	int32 FindWithin(EBufferedInput Input, double Now, float Window) const;
+
+	FEvent Events[Capacity];
+	int32 Head = 0;
+	int32 Num = 0;
+};
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeInputRecording.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+	const uint32 RecordingMagic = 0x43524E47; // "GNRC"
+	const uint32 RecordingVersion = 2;
+	const uint8 FrameDeltaTimeChanged = 1 << 0;
+	const uint8 EventValueChanged = 1 << 7;
+
+	bool HasValue(EGnomeRecordedInput Input)
+	{
+		return Input == EGnomeRecordedInput::Move || Input == EGnomeRecordedInput::Look;
+	}
+}
+
+void FGnomeInputRecorder::Begin(const FTransform& StartTransform, const FRotator& StartControlRotation)
+{
+	Data.Reset();
+	FrameEvents.Reset();
+	NumFrames = 0;
+	LastDeltaTime = 0.f;
+	LastMove = FVector2f::ZeroVector;
+	LastLook = FVector2f::ZeroVector;
+
+	FMemoryWriter Writer(Data);
+	uint32 Magic = RecordingMagic;
+	uint32 Version = RecordingVersion;
+	FTransform Transform = StartTransform;
+	FRotator ControlRotation = StartControlRotation;
+	Writer << Magic << Version << Transform << ControlRotation;
+}
+
+void FGnomeInputRecorder::RecordEvent(EGnomeRecordedInput Input, const FVector2D& Value)
+{
+	FrameEvents.Add({ Input, FVector2f(Value) });
+}
+
+void FGnomeInputRecorder::EndFrame(float FrameDeltaTime)
+{
+	FMemoryWriter Writer(Data);
+	Writer.Seek(Data.Num());
+
+	uint8 Flags = FrameDeltaTime != LastDeltaTime ? FrameDeltaTimeChanged : 0;
+	Writer << Flags;
+	if (Flags & FrameDeltaTimeChanged)
+	{
+		Writer << FrameDeltaTime;
+		LastDeltaTime = FrameDeltaTime;
+	}
+
+	// Packed so a typical frame still spends one byte on it, without capping the events a frame can hold
+	uint32 NumEvents = FrameEvents.Num();
+	Writer.SerializeIntPacked(NumEvents);
+	for (uint32 i = 0; i < NumEvents; i++)
+	{
+		FGnomeRecordedEvent& Event = FrameEvents[i];
+		uint8 Code = (uint8)Event.Input;
+		if (!HasValue(Event.Input))
+		{
+			Writer << Code;
+			continue;
+		}
+
+		FVector2f& LastValue = Event.Input == EGnomeRecordedInput::Move ? LastMove : LastLook;
+		bool ValueChanged = Event.Value != LastValue;
+		Code |= ValueChanged ? EventValueChanged : 0;
+		Writer << Code;
+		if (ValueChanged)
+		{
+			Writer << Event.Value.X << Event.Value.Y;
+			LastValue = Event.Value;
+		}
+	}
+
+	FrameEvents.Reset();
+	NumFrames++;
+}
+
+bool FGnomeInputRecorder::Save(const FString& Path) const
+{
+	return FFileHelper::SaveArrayToFile(Data, *Path);
+}
+
+bool FGnomeInputPlayer::Load(const FString& Path)
+{
+	if (!FFileHelper::LoadFileToArray(Data, *Path))
+		return false;
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != RecordingMagic || Version != RecordingVersion)
+		return false;
+	Reader << StartTransform << StartControlRotation;
+
+	Offset = Reader.Tell();
+	LastDeltaTime = 0.f;
+	LastMove = FVector2f::ZeroVector;
+	LastLook = FVector2f::ZeroVector;
+	return !Reader.IsError();
+}
+
+bool FGnomeInputPlayer::ReadFrame(float& OutFrameDeltaTime, TArray<FGnomeRecordedEvent>& OutEvents)
+{
+	OutEvents.Reset();
+	if (Offset >= Data.Num())
+		return false;
+
+	FMemoryReader Reader(Data);
+	Reader.Seek(Offset);
+
+	uint8 Flags = 0;
+	Reader << Flags;
+	if (Flags & FrameDeltaTimeChanged)
+		Reader << LastDeltaTime;
+	OutFrameDeltaTime = LastDeltaTime;
+
+	uint32 NumEvents = 0;
+	Reader.SerializeIntPacked(NumEvents);
+	if (Reader.IsError() || NumEvents > (uint32)(Data.Num() - Reader.Tell()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Gnome input recording has a corrupt frame at offset %d"), Offset);
+		return false;
+	}
+	for (uint32 i = 0; i < NumEvents; i++)
+	{
+		uint8 Code = 0;
+		Reader << Code;
+		EGnomeRecordedInput Input = (EGnomeRecordedInput)(Code & ~EventValueChanged);
+		FVector2f Value = FVector2f::ZeroVector;
+		if (HasValue(Input))
+		{
+			FVector2f& LastValue = Input == EGnomeRecordedInput::Move ? LastMove : LastLook;
+			if (Code & EventValueChanged)
+				Reader << LastValue.X << LastValue.Y;
+			Value = LastValue;
+		}
+		OutEvents.Add({ Input, Value });
+	}
+
+	Offset = Reader.Tell();
+	return !Reader.IsError();
+}
+
+bool FGnomeInputPlayer::PeekFrameDeltaTime(float& OutFrameDeltaTime) const
+{
+	if (Offset >= Data.Num())
+		return false;
+
+	uint8 Flags = Data[Offset];
+	OutFrameDeltaTime = LastDeltaTime;
+	if (Flags & FrameDeltaTimeChanged)
+		FMemory::Memcpy(&OutFrameDeltaTime, &Data[Offset + 1], sizeof(float));
+	return true;
+}
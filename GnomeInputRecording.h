@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EGnomeRecordedInput : uint8
+{
+	Move,
+	Look,
+	MoveCleared,
+	JumpPressed,
+	JumpReleased,
+	DodgePressed,
+	DodgeReleased,
+	AttackPressed,
+	AttackReleased,
+	ThrowSeedPressed,
+	ThrowSeedReleased
+};
+
+struct FGnomeRecordedEvent
+{
+	EGnomeRecordedInput Input;
+	FVector2f Value;
+};
+
+/**
+ * Captures the frame times and input callbacks the character receives into a compact binary stream.
+ * Each frame is a flags byte, the frame time only when it changed, a packed event count and the events,
+ * where Move and Look only carry a value when it differs from the last one sent
+ */
+class GARDENGAME_API FGnomeInputRecorder
+{
+public:
+	void Begin(const FTransform& StartTransform, const FRotator& StartControlRotation);
+	void RecordEvent(EGnomeRecordedInput Input, const FVector2D& Value = FVector2D::ZeroVector);
+	// Writes the events received since the last call as one frame
+	void EndFrame(float FrameDeltaTime);
+	bool Save(const FString& Path) const;
+	int32 GetNumFrames() const { return NumFrames; }
+
+private:
+	TArray<uint8> Data;
+	TArray<FGnomeRecordedEvent> FrameEvents;
+	int32 NumFrames = 0;
+	float LastDeltaTime = 0.f;
+	FVector2f LastMove = FVector2f::ZeroVector;
+	FVector2f LastLook = FVector2f::ZeroVector;
+};
+
+/**
+ * Reads back a stream written by FGnomeInputRecorder one frame at a time
+ */
+class GARDENGAME_API FGnomeInputPlayer
+{
+public:
+	bool Load(const FString& Path);
+	bool ReadFrame(float& OutFrameDeltaTime, TArray<FGnomeRecordedEvent>& OutEvents);
+	// Frame time of the frame ReadFrame returns next, so the engine can be told in advance
+	bool PeekFrameDeltaTime(float& OutFrameDeltaTime) const;
+
+	FTransform StartTransform;
+	FRotator StartControlRotation;
+
+private:
+	TArray<uint8> Data;
+	int32 Offset = 0;
+	float LastDeltaTime = 0.f;
+	FVector2f LastMove = FVector2f::ZeroVector;
+	FVector2f LastLook = FVector2f::ZeroVector;
+};
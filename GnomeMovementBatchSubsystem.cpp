@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeMovementBatchSubsystem.h"
+#include "GardenGameCharacter.h"
+#include "GnomeMovementKernel.h"
+#include "Engine/World.h"
+#include "GardenGameCharacterStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("MovementBatch"), STAT_GnomeMovementBatch, STATGROUP_GardenGameCharacter);
+
+void FGnomeMovementBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem)
+		Subsystem->RunBatch();
+}
+
+FString FGnomeMovementBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("FGnomeMovementBatchTickFunction");
+}
+
+void UGnomeMovementBatchSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	BatchTickFunction.Subsystem = this;
+	BatchTickFunction.bCanEverTick = true;
+	BatchTickFunction.TickGroup = TG_PrePhysics;
+	BatchTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UGnomeMovementBatchSubsystem::Deinitialize()
+{
+	if (BatchTickFunction.IsTickFunctionRegistered())
+		BatchTickFunction.UnRegisterTickFunction();
+	BatchTickFunction.Subsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UGnomeMovementBatchSubsystem::RegisterCharacter(AGardenGameCharacter* Character)
+{
+	// Character tick -> batch -> movement component tick
+	BatchTickFunction.AddPrerequisite(Character, Character->PrimaryActorTick);
+	Character->MovementComponent->PrimaryComponentTick.AddPrerequisite(this, BatchTickFunction);
+}
+
+void UGnomeMovementBatchSubsystem::UnregisterCharacter(AGardenGameCharacter* Character)
+{
+	BatchTickFunction.RemovePrerequisite(Character, Character->PrimaryActorTick);
+	Character->MovementComponent->PrimaryComponentTick.RemovePrerequisite(this, BatchTickFunction);
+
+	int32 Index;
+	while (Characters.Find(Character, Index))
+		Characters[Index] = nullptr;
+}
+
+void UGnomeMovementBatchSubsystem::QueueAirMove(AGardenGameCharacter* Character, const FVector& Velocity, const FVector& MoveInput, float InAcceleration, float InDeceleration, float InMaxSpeed, float InFallAcceleration, float InMaxFallSpeed, float InDeltaTime)
+{
+	Characters.Add(Character);
+	VelocityX.Add(Velocity.X);
+	VelocityY.Add(Velocity.Y);
+	VelocityZ.Add(Velocity.Z);
+	MoveInputX.Add(MoveInput.X);
+	MoveInputY.Add(MoveInput.Y);
+	Acceleration.Add(InAcceleration);
+	Deceleration.Add(InDeceleration);
+	MaxSpeed.Add(InMaxSpeed);
+	FallAcceleration.Add(InFallAcceleration);
+	MaxFallSpeed.Add(InMaxFallSpeed);
+	// The character's own step, which is longer than the frame when it ticks at a reduced rate
+	DeltaTime.Add(InDeltaTime);
+}
+
+void UGnomeMovementBatchSubsystem::RunBatch()
+{
+	SCOPE_GNOME_STAT(MovementBatch);
+	if (Characters.Num() == 0)
+		return;
+
+	GnomeMovement::FMoveBatch Batch;
+	Batch.Count = Characters.Num();
+	Batch.VelocityX = VelocityX.GetData();
+	Batch.VelocityY = VelocityY.GetData();
+	Batch.VelocityZ = VelocityZ.GetData();
+	Batch.MoveInputX = MoveInputX.GetData();
+	Batch.MoveInputY = MoveInputY.GetData();
+	Batch.Acceleration = Acceleration.GetData();
+	Batch.Deceleration = Deceleration.GetData();
+	Batch.MaxSpeed = MaxSpeed.GetData();
+	Batch.FallAcceleration = FallAcceleration.GetData();
+	Batch.MaxFallSpeed = MaxFallSpeed.GetData();
+	Batch.DeltaTime = DeltaTime.GetData();
+	GnomeMovement::HandleMoveBatch(Batch);
+
+	for (int32 i = 0; i < Characters.Num(); i++)
+	{
+		if (Characters[i])
+			Characters[i]->ApplyBatchedVelocity(FVector(VelocityX[i], VelocityY[i], VelocityZ[i]));
+	}
+
+	// Keep the allocations for next frame
+	Characters.Reset();
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+	MoveInputX.Reset();
+	MoveInputY.Reset();
+	Acceleration.Reset();
+	Deceleration.Reset();
+	MaxSpeed.Reset();
+	FallAcceleration.Reset();
+	MaxFallSpeed.Reset();
+	DeltaTime.Reset();
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "GnomeMovementBatchSubsystem.generated.h"
+
+class AGardenGameCharacter;
+class UGnomeMovementBatchSubsystem;
+
+USTRUCT()
+struct FGnomeMovementBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UGnomeMovementBatchSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGnomeMovementBatchTickFunction> : public TStructOpsTypeTraitsBase2<FGnomeMovementBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Runs the airborne velocity integration of every registered gnome in one vectorized pass,
+ * after the gnomes have ticked and before their movement components move them
+ */
+UCLASS()
+class GARDENGAME_API UGnomeMovementBatchSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void RegisterCharacter(AGardenGameCharacter* Character);
+	void UnregisterCharacter(AGardenGameCharacter* Character);
+	void QueueAirMove(AGardenGameCharacter* Character, const FVector& Velocity, const FVector& MoveInput, float Acceleration, float Deceleration, float MaxSpeed, float FallAcceleration, float MaxFallSpeed, float DeltaTime);
+	void RunBatch();
+
+private:
+	FGnomeMovementBatchTickFunction BatchTickFunction;
+
+	// Structure of arrays, one entry per queued move, cleared after every batch
+	TArray<AGardenGameCharacter*> Characters;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> MoveInputX;
+	TArray<float> MoveInputY;
+	TArray<float> Acceleration;
+	TArray<float> Deceleration;
+	TArray<float> MaxSpeed;
+	TArray<float> FallAcceleration;
+	TArray<float> MaxFallSpeed;
+	TArray<float> DeltaTime;
+};
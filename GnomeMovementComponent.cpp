@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeMovementComponent.h"
+#include "GardenGameCharacter.h"
+#include "GardenGameCharacterStats.h"
+#include "Engine/World.h"
+#include "Misc/ScopeLock.h"
+
+UGnomeMovementComponent::UGnomeMovementComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UGnomeMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	GnomeOwner = Cast<AGardenGameCharacter>(GetOwner());
+	// The gnome's tick produces the velocity this moves by
+	if (GnomeOwner)
+		PrimaryComponentTick.AddPrerequisite(GnomeOwner, GnomeOwner->PrimaryActorTick);
+
+	if (RunOnAsyncPhysicsTick && UpdatedPrimitive)
+	{
+		// Captured here so the physics thread never reads the primitive
+		AsyncCollisionChannel = UpdatedPrimitive->GetCollisionObjectType();
+		AsyncQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(GnomeAsyncMove), false, GetOwner());
+		UpdatedPrimitive->InitSweepCollisionParams(AsyncQueryParams, AsyncResponseParams);
+		SetAsyncPhysicsTickEnabled(true);
+	}
+}
+
+void UGnomeMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (ShouldSkipUpdate(DeltaTime))
+		return;
+
+	if (RunOnAsyncPhysicsTick)
+		ExchangeAsyncMove();
+	else
+		MoveByVelocity(DeltaTime);
+}
+
+void UGnomeMovementComponent::AsyncPhysicsTickComponent(float DeltaTime, float SimTime)
+{
+	Super::AsyncPhysicsTickComponent(DeltaTime, SimTime);
+
+	FGnomeAsyncMoveInput Input;
+	FGnomeAsyncMoveOutput Output;
+	{
+		FScopeLock Lock(&AsyncMoveLock);
+		Input = AsyncMoveInput;
+		Output = AsyncMoveOutput;
+	}
+	if (!Input.IsActive)
+		return;
+
+	// A new game frame restarts from wherever the game thread put the gnome
+	if (Output.InputSerial != Input.Serial)
+	{
+		Output = FGnomeAsyncMoveOutput();
+		Output.Location = Input.Location;
+		Output.InputSerial = Input.Serial;
+	}
+	AsyncSweepAndSlide(Input, DeltaTime, Output);
+
+	FScopeLock Lock(&AsyncMoveLock);
+	// Dropped if the game thread published again while we swept, the next step starts from its input
+	if (AsyncMoveInput.Serial == Output.InputSerial)
+		AsyncMoveOutput = Output;
+}
+
+void UGnomeMovementComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	Super::SetComponentTickEnabled(bEnabled);
+
+	// Sleeping and self moving gnomes must not be stepped by the physics thread
+	if (!bEnabled)
+	{
+		FScopeLock Lock(&AsyncMoveLock);
+		AsyncMoveInput.IsActive = false;
+	}
+}
+
+void UGnomeMovementComponent::ExchangeAsyncMove()
+{
+	if (!UpdatedComponent)
+		return;
+
+	// Apply and publish under one lock so no physics step lands between them and gets lost
+	FScopeLock Lock(&AsyncMoveLock);
+	// Anything that moved the gnome on the game thread since the last publish, a teleport, wins
+	bool MovedByOwner = !UpdatedComponent->GetComponentLocation().Equals(AsyncMoveInput.Location);
+	if (AsyncMoveInput.IsActive && AsyncMoveOutput.InputSerial == AsyncMoveInput.Serial && !MovedByOwner)
+	{
+		UpdatedComponent->SetWorldLocation(AsyncMoveOutput.Location);
+		// Walls and ceilings take away the velocity they blocked
+		if (AsyncMoveOutput.IsBlocked && FVector::DotProduct(Velocity, AsyncMoveOutput.BlockingNormal) < 0.f)
+			Velocity = FVector::VectorPlaneProject(Velocity, AsyncMoveOutput.BlockingNormal);
+	}
+
+	AsyncMoveInput.Location = UpdatedComponent->GetComponentLocation();
+	AsyncMoveInput.Rotation = UpdatedComponent->GetComponentQuat();
+	AsyncMoveInput.Velocity = Velocity;
+	AsyncMoveInput.Shape = UpdatedPrimitive ? UpdatedPrimitive->GetCollisionShape() : FCollisionShape();
+	AsyncMoveInput.HasGroundContact = HasGroundContact;
+	AsyncMoveInput.GroundNormal = GroundNormal;
+	AsyncMoveInput.IsActive = true;
+	AsyncMoveInput.Serial++;
+	UpdateComponentVelocity();
+}
+
+void UGnomeMovementComponent::AsyncSweepAndSlide(const FGnomeAsyncMoveInput& Input, float DeltaTime, FGnomeAsyncMoveOutput& Output) const
+{
+	UWorld* World = GetWorld();
+	if (!World || DeltaTime <= 0.f)
+		return;
+
+	FVector Delta = Input.Velocity * DeltaTime;
+	if (Delta.IsNearlyZero())
+		return;
+	if (Input.HasGroundContact && FVector::DotProduct(Delta, Input.GroundNormal) < 0.f)
+		Delta = FVector::VectorPlaneProject(Delta, Input.GroundNormal);
+
+	// Read only scene queries, the same kind async traces run off the game thread
+	INC_GNOME_COUNTER(MovementSweeps);
+	FHitResult Hit;
+	if (!World->SweepSingleByChannel(Hit, Output.Location, Output.Location + Delta, Input.Rotation, AsyncCollisionChannel, Input.Shape, AsyncQueryParams, AsyncResponseParams))
+	{
+		Output.Location += Delta;
+		return;
+	}
+
+	Output.IsBlocked = true;
+	Output.BlockingNormal = Hit.Normal;
+	if (Hit.bStartPenetrating)
+		return;
+	Output.Location = Hit.Location;
+
+	FVector SlideDelta = ComputeSlideVector(Delta, 1.f - Hit.Time, Hit.Normal, Hit);
+	if (FVector::DotProduct(SlideDelta, Delta) <= 0.f || SlideDelta.IsNearlyZero())
+		return;
+
+	INC_GNOME_COUNTER(MovementSweeps);
+	FHitResult SlideHit;
+	if (World->SweepSingleByChannel(SlideHit, Output.Location, Output.Location + SlideDelta, Input.Rotation, AsyncCollisionChannel, Input.Shape, AsyncQueryParams, AsyncResponseParams))
+		Output.Location = SlideHit.bStartPenetrating ? Output.Location : SlideHit.Location;
+	else
+		Output.Location += SlideDelta;
+}
+
+void UGnomeMovementComponent::MoveByVelocity(float DeltaTime)
+{
+	if (!UpdatedComponent || DeltaTime <= 0.f)
+		return;
+
+	FVector Delta = Velocity * DeltaTime;
+	if (Delta.IsNearlyZero())
+		return;
+
+	// Keep a grounded step along the floor so the sweep does not start by hitting it
+	if (HasGroundContact && FVector::DotProduct(Delta, GroundNormal) < 0.f)
+		Delta = FVector::VectorPlaneProject(Delta, GroundNormal);
+
+	INC_GNOME_COUNTER(MovementSweeps);
+	FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	FHitResult Hit;
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+	if (Hit.IsValidBlockingHit())
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+
+	// Walls and ceilings take away the velocity they blocked
+	Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / DeltaTime;
+	UpdateComponentVelocity();
+}
+
+void UGnomeMovementComponent::SetGroundContact(const FHitResult* GroundHit)
+{
+	HasGroundContact = GroundHit != nullptr;
+	if (GroundHit)
+		GroundNormal = GroundHit->ImpactNormal;
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "HAL/CriticalSection.h"
+#include "GnomeMovementComponent.generated.h"
+
+class AGardenGameCharacter;
+
+// What the game thread hands the physics thread, published once per game frame
+struct FGnomeAsyncMoveInput
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Velocity = FVector::ZeroVector;
+	FCollisionShape Shape;
+	bool HasGroundContact = false;
+	FVector GroundNormal = FVector::UpVector;
+	bool IsActive = false;
+	uint32 Serial = 0;
+};
+
+// Where the physics thread got to from the input with the same serial
+struct FGnomeAsyncMoveOutput
+{
+	FVector Location = FVector::ZeroVector;
+	bool IsBlocked = false;
+	FVector BlockingNormal = FVector::ZeroVector;
+	uint32 InputSerial = 0;
+};
+
+/**
+ * Moves the gnome by the velocity its state machine produced, with no acceleration or braking of its own
+ */
+UCLASS(ClassGroup = Movement, meta = (BlueprintSpawnableComponent))
+class GARDENGAME_API UGnomeMovementComponent : public UPawnMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGnomeMovementComponent();
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void AsyncPhysicsTickComponent(float DeltaTime, float SimTime) override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
+
+	// One sweep and slide along Velocity, Velocity is left as the distance actually travelled
+	void MoveByVelocity(float DeltaTime);
+	// The surface the gnome is standing on, or null when it is not grounded
+	void SetGroundContact(const FHitResult* GroundHit);
+
+protected:
+	// Sweep on the physics tick instead of the component tick, the state machine stays on the game thread
+	UPROPERTY(EditAnywhere, Category = "Gnome Movement")
+		bool RunOnAsyncPhysicsTick;
+
+private:
+	// Game thread, applies the physics thread's result and publishes this frame's velocity
+	void ExchangeAsyncMove();
+	// Physics thread, only queries the scene and never touches the component
+	void AsyncSweepAndSlide(const FGnomeAsyncMoveInput& Input, float DeltaTime, FGnomeAsyncMoveOutput& Output) const;
+
+	AGardenGameCharacter* GnomeOwner;
+	bool HasGroundContact;
+	FVector GroundNormal;
+
+	// Async physics tick
+	FCriticalSection AsyncMoveLock;
+	FGnomeAsyncMoveInput AsyncMoveInput;
+	FGnomeAsyncMoveOutput AsyncMoveOutput;
+	ECollisionChannel AsyncCollisionChannel;
+	FCollisionQueryParams AsyncQueryParams;
+	FCollisionResponseParams AsyncResponseParams;
+};
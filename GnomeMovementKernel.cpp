@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeMovementKernel.h"
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GNOME_MOVEMENT_SSE 1
+#else
+#define GNOME_MOVEMENT_SSE 0
+#endif
+
+namespace GnomeMovement
+{
+	static float Length(const FVec3& V)
+	{
+		return std::sqrt(V.X * V.X + V.Y * V.Y + V.Z * V.Z);
+	}
+
+	static float Dot(const FVec3& A, const FVec3& B)
+	{
+		return A.X * B.X + A.Y * B.Y + A.Z * B.Z;
+	}
+
+	static FVec3 Scale(const FVec3& V, float S)
+	{
+		return { V.X * S, V.Y * S, V.Z * S };
+	}
+
+	static FVec3 Accelerate(const FVec3& Current, const FVec3& Target, const FMoveStats& Stats, float DeltaTime)
+	{
+		if (Length(Target) == 0 || Stats.Acceleration == 0) //Decelerating
+			return MoveVectorTowards(Current, { 0, 0, 0 }, Stats.Deceleration * DeltaTime);
+		//Accelerating
+		return MoveVectorTowards(Current, Target, Stats.Acceleration * DeltaTime);
+	}
+
+	FVec3 MoveVectorTowards(const FVec3& Current, const FVec3& Target, float MaxDistanceDelta)
+	{
+		FVec3 A = { Target.X - Current.X, Target.Y - Current.Y, Target.Z - Current.Z };
+		float Magnitude = Length(A);
+		if (Magnitude <= MaxDistanceDelta || Magnitude == 0.f)
+			return Target;
+		float Step = MaxDistanceDelta / Magnitude;
+		return { Current.X + A.X * Step, Current.Y + A.Y * Step, Current.Z + A.Z * Step };
+	}
+
+	void HandleMove(FMoveState& State, const FMoveStats& Stats, float DeltaTime)
+	{
+		FVec3 CurrentHorizontalVelocity = { State.Velocity.X, State.Velocity.Y, 0 };
+		FVec3 TargetVelocity = Scale(State.MoveInput, Stats.MaxSpeed);
+
+		FVec3 NewHorizontalVelocity = Accelerate(CurrentHorizontalVelocity, TargetVelocity, Stats, DeltaTime);
+		State.Velocity.X = NewHorizontalVelocity.X;
+		State.Velocity.Y = NewHorizontalVelocity.Y;
+	}
+
+	void HandleGroundedMove(FMoveState& State, const FMoveStats& Stats, const FVec3& GroundNormal, float DeltaTime)
+	{
+		// Project the input onto the ground plane, GroundNormal is expected to be normalized
+		float InputIntoGround = Dot(State.MoveInput, GroundNormal);
+		FVec3 RotatedMoveInput = {
+			State.MoveInput.X - GroundNormal.X * InputIntoGround,
+			State.MoveInput.Y - GroundNormal.Y * InputIntoGround,
+			State.MoveInput.Z - GroundNormal.Z * InputIntoGround
+		};
+		FVec3 TargetVelocity = Scale(RotatedMoveInput, Stats.MaxSpeed);
+
+		State.Velocity = Accelerate(State.Velocity, TargetVelocity, Stats, DeltaTime);
+	}
+
+	void HandleGravity(FMoveState& State, float Acceleration, float MaxFallSpeed, float DeltaTime)
+	{
+		float NewFallSpeed = State.Velocity.Z - (Acceleration * DeltaTime);
+		State.Velocity.Z = NewFallSpeed < -MaxFallSpeed ? -MaxFallSpeed : NewFallSpeed;
+	}
+
+	static void HandleMoveBatchScalar(const FMoveBatch& Batch, int Start)
+	{
+		for (int i = Start; i < Batch.Count; i++)
+		{
+			float DeltaTime = Batch.DeltaTime[i];
+			FMoveState State = { { Batch.VelocityX[i], Batch.VelocityY[i], Batch.VelocityZ[i] }, { Batch.MoveInputX[i], Batch.MoveInputY[i], 0 } };
+			HandleMove(State, { Batch.Acceleration[i], Batch.Deceleration[i], Batch.MaxSpeed[i] }, DeltaTime);
+			HandleGravity(State, Batch.FallAcceleration[i], Batch.MaxFallSpeed[i], DeltaTime);
+			Batch.VelocityX[i] = State.Velocity.X;
+			Batch.VelocityY[i] = State.Velocity.Y;
+			Batch.VelocityZ[i] = State.Velocity.Z;
+		}
+	}
+
+	void HandleMoveBatch(const FMoveBatch& Batch)
+	{
+		int i = 0;
+#if GNOME_MOVEMENT_SSE
+		const __m128 Zero = _mm_setzero_ps();
+		for (; i + 4 <= Batch.Count; i += 4)
+		{
+			__m128 Delta = _mm_loadu_ps(Batch.DeltaTime + i);
+			__m128 VelX = _mm_loadu_ps(Batch.VelocityX + i);
+			__m128 VelY = _mm_loadu_ps(Batch.VelocityY + i);
+			__m128 VelZ = _mm_loadu_ps(Batch.VelocityZ + i);
+			__m128 MaxSpeed = _mm_loadu_ps(Batch.MaxSpeed + i);
+			__m128 Acceleration = _mm_loadu_ps(Batch.Acceleration + i);
+			__m128 TargetX = _mm_mul_ps(_mm_loadu_ps(Batch.MoveInputX + i), MaxSpeed);
+			__m128 TargetY = _mm_mul_ps(_mm_loadu_ps(Batch.MoveInputY + i), MaxSpeed);
+
+			// Lanes with no target or no acceleration decelerate towards zero instead
+			__m128 TargetLengthSq = _mm_add_ps(_mm_mul_ps(TargetX, TargetX), _mm_mul_ps(TargetY, TargetY));
+			__m128 Decelerating = _mm_or_ps(_mm_cmpeq_ps(TargetLengthSq, Zero), _mm_cmpeq_ps(Acceleration, Zero));
+			TargetX = _mm_andnot_ps(Decelerating, TargetX);
+			TargetY = _mm_andnot_ps(Decelerating, TargetY);
+			__m128 Rate = _mm_or_ps(_mm_and_ps(Decelerating, _mm_loadu_ps(Batch.Deceleration + i)), _mm_andnot_ps(Decelerating, Acceleration));
+			__m128 MaxDistanceDelta = _mm_mul_ps(Rate, Delta);
+
+			// MoveVectorTowards
+			__m128 AX = _mm_sub_ps(TargetX, VelX);
+			__m128 AY = _mm_sub_ps(TargetY, VelY);
+			__m128 Magnitude = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(AX, AX), _mm_mul_ps(AY, AY)));
+			__m128 Arrived = _mm_or_ps(_mm_cmple_ps(Magnitude, MaxDistanceDelta), _mm_cmpeq_ps(Magnitude, Zero));
+			__m128 Step = _mm_div_ps(MaxDistanceDelta, Magnitude);
+			__m128 MovedX = _mm_add_ps(VelX, _mm_mul_ps(AX, Step));
+			__m128 MovedY = _mm_add_ps(VelY, _mm_mul_ps(AY, Step));
+			VelX = _mm_or_ps(_mm_and_ps(Arrived, TargetX), _mm_andnot_ps(Arrived, MovedX));
+			VelY = _mm_or_ps(_mm_and_ps(Arrived, TargetY), _mm_andnot_ps(Arrived, MovedY));
+
+			// HandleGravity
+			__m128 FallSpeed = _mm_sub_ps(VelZ, _mm_mul_ps(_mm_loadu_ps(Batch.FallAcceleration + i), Delta));
+			VelZ = _mm_max_ps(FallSpeed, _mm_sub_ps(Zero, _mm_loadu_ps(Batch.MaxFallSpeed + i)));
+
+			_mm_storeu_ps(Batch.VelocityX + i, VelX);
+			_mm_storeu_ps(Batch.VelocityY + i, VelY);
+			_mm_storeu_ps(Batch.VelocityZ + i, VelZ);
+		}
+#endif
+		HandleMoveBatchScalar(Batch, i);
+	}
+
+	bool ValidGroundAngle(const FVec3& GroundNormal, float MinGroundNormalZ)
+	{
+		return GroundNormal.Z >= MinGroundNormalZ;
+	}
+}
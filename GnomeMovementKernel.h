@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Per-tick movement math for the gnome, kept free of engine types so it can be built and measured on its own
+ */
+namespace GnomeMovement
+{
+	struct FVec3
+	{
+		float X;
+		float Y;
+		float Z;
+	};
+
+	struct FMoveState
+	{
+		FVec3 Velocity;
+		FVec3 MoveInput;
+	};
+
+	struct FMoveStats
+	{
+		float Acceleration;
+		float Deceleration;
+		float MaxSpeed;
+	};
+
+	// Structure-of-arrays view of many airborne moves (HandleMove followed by HandleGravity), input is horizontal only
+	struct FMoveBatch
+	{
+		int Count;
+		float* VelocityX;
+		float* VelocityY;
+		float* VelocityZ;
+		const float* MoveInputX;
+		const float* MoveInputY;
+		const float* Acceleration;
+		const float* Deceleration;
+		const float* MaxSpeed;
+		const float* FallAcceleration;
+		const float* MaxFallSpeed;
+		// Per entry, gnomes ticking at a reduced rate integrate over their own interval
+		const float* DeltaTime;
+	};
+
+	FVec3 MoveVectorTowards(const FVec3& Current, const FVec3& Target, float MaxDistanceDelta);
+	// Horizontal acceleration/deceleration used in the air, leaves Velocity.Z untouched
+	void HandleMove(FMoveState& State, const FMoveStats& Stats, float DeltaTime);
+	// Acceleration/deceleration along the ground plane
+	void HandleGroundedMove(FMoveState& State, const FMoveStats& Stats, const FVec3& GroundNormal, float DeltaTime);
+	void HandleGravity(FMoveState& State, float Acceleration, float MaxFallSpeed, float DeltaTime);
+	// Same result as HandleMove + HandleGravity for every entry, four entries at a time where SSE is available
+	void HandleMoveBatch(const FMoveBatch& Batch);
+	// MinGroundNormalZ is the cosine of the steepest walkable slope
+	bool ValidGroundAngle(const FVec3& GroundNormal, float MinGroundNormalZ);
+}
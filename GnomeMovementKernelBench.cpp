@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeMovementKernel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace GnomeMovement;
+
+// Usage: GnomeMovementKernelBench [gnomes] [frames]
+int main(int argc, char** argv)
+{
+	const int Count = argc > 1 ? std::atoi(argv[1]) : 1024;
+	const int Frames = argc > 2 ? std::atoi(argv[2]) : 2000;
+	const float DeltaTime = 1.f / 60.f;
+
+	std::vector<float> VelX(Count), VelY(Count), VelZ(Count);
+	std::vector<float> InputX(Count), InputY(Count), Acceleration(Count, 2000.f), Deceleration(Count, 3000.f), MaxSpeed(Count, 600.f), FallAcceleration(Count, 980.f), MaxFallSpeed(Count, 4000.f), DeltaTimes(Count, DeltaTime);
+	std::vector<FMoveState> States(Count);
+	for (int i = 0; i < Count; i++)
+	{
+		InputX[i] = (i % 3) - 1.f;
+		InputY[i] = ((i / 3) % 3) - 1.f;
+		States[i] = { { 0, 0, 0 }, { InputX[i], InputY[i], 0 } };
+	}
+
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point Start = Clock::now();
+	for (int Frame = 0; Frame < Frames; Frame++)
+	{
+		for (int i = 0; i < Count; i++)
+		{
+			HandleMove(States[i], { Acceleration[i], Deceleration[i], MaxSpeed[i] }, DeltaTime);
+			HandleGravity(States[i], FallAcceleration[i], MaxFallSpeed[i], DeltaTime);
+		}
+	}
+	double ScalarMs = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+
+	Start = Clock::now();
+	for (int Frame = 0; Frame < Frames; Frame++)
+	{
+		FMoveBatch Batch = { Count, VelX.data(), VelY.data(), VelZ.data(), InputX.data(), InputY.data(), Acceleration.data(), Deceleration.data(), MaxSpeed.data(), FallAcceleration.data(), MaxFallSpeed.data(), DeltaTimes.data() };
+		HandleMoveBatch(Batch);
+	}
+	double BatchMs = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+
+	// Read the results back so the loops cannot be optimized away
+	float Checksum = 0.f;
+	for (int i = 0; i < Count; i++)
+		Checksum += States[i].Velocity.X + VelX[i];
+
+	double Moves = double(Count) * Frames;
+	std::printf("%d gnomes x %d frames (checksum %f)\n", Count, Frames, Checksum);
+	std::printf("scalar: %8.2f ms  %6.2f ns/move\n", ScalarMs, ScalarMs * 1e6 / Moves);
+	std::printf("batch:  %8.2f ms  %6.2f ns/move\n", BatchMs, BatchMs * 1e6 / Moves);
+	return 0;
+}
@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeMovementKernel.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace GnomeMovement;
+
+static int Failures = 0;
+
+#define CHECK(Condition) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Condition); \
+			Failures++; \
+		} \
+	} while (0)
+
+static bool NearlyEqual(float A, float B, float Tolerance = 1e-4f)
+{
+	return std::fabs(A - B) <= Tolerance * (1.f + std::fabs(B));
+}
+
+static bool NearlyEqual(const FVec3& A, const FVec3& B)
+{
+	return NearlyEqual(A.X, B.X) && NearlyEqual(A.Y, B.Y) && NearlyEqual(A.Z, B.Z);
+}
+
+static void TestMoveVectorTowards()
+{
+	// Within reach snaps to the target
+	CHECK(NearlyEqual(MoveVectorTowards({ 0, 0, 0 }, { 3, 4, 0 }, 5.f), { 3, 4, 0 }));
+	CHECK(NearlyEqual(MoveVectorTowards({ 0, 0, 0 }, { 3, 4, 0 }, 10.f), { 3, 4, 0 }));
+	// Otherwise moves exactly MaxDistanceDelta along the line
+	CHECK(NearlyEqual(MoveVectorTowards({ 0, 0, 0 }, { 3, 4, 0 }, 2.5f), { 1.5f, 2, 0 }));
+	CHECK(NearlyEqual(MoveVectorTowards({ 1, 1, 1 }, { 1, 1, 11 }, 4.f), { 1, 1, 5 }));
+	// Already there
+	CHECK(NearlyEqual(MoveVectorTowards({ 2, 2, 2 }, { 2, 2, 2 }, 0.f), { 2, 2, 2 }));
+}
+
+static void TestHandleMove()
+{
+	FMoveStats Stats = { 1000.f, 2000.f, 500.f };
+
+	// Accelerates towards input * MaxSpeed and leaves Z alone
+	FMoveState State = { { 0, 0, -50 }, { 1, 0, 0 } };
+	HandleMove(State, Stats, 0.1f);
+	CHECK(NearlyEqual(State.Velocity, { 100, 0, -50 }));
+
+	// Clamped at the target speed
+	for (int i = 0; i < 20; i++)
+		HandleMove(State, Stats, 0.1f);
+	CHECK(NearlyEqual(State.Velocity, { 500, 0, -50 }));
+
+	// No input decelerates with the deceleration rate
+	State.MoveInput = { 0, 0, 0 };
+	HandleMove(State, Stats, 0.1f);
+	CHECK(NearlyEqual(State.Velocity, { 300, 0, -50 }));
+
+	// No acceleration decelerates as well, even with input
+	FMoveState Stuck = { { 0, 300, 0 }, { 1, 0, 0 } };
+	HandleMove(Stuck, { 0.f, 2000.f, 500.f }, 0.1f);
+	CHECK(NearlyEqual(Stuck.Velocity, { 0, 100, 0 }));
+}
+
+static void TestHandleGroundedMove()
+{
+	FMoveStats Stats = { 1000.f, 2000.f, 500.f };
+
+	// Flat ground behaves like HandleMove without a vertical component
+	FMoveState Flat = { { 0, 0, 0 }, { 0, 1, 0 } };
+	HandleGroundedMove(Flat, Stats, { 0, 0, 1 }, 0.1f);
+	CHECK(NearlyEqual(Flat.Velocity, { 0, 100, 0 }));
+
+	// On a 45 degree slope the input is projected onto the ground plane
+	const float InvSqrt2 = 1.f / std::sqrt(2.f);
+	FMoveState Slope = { { 0, 0, 0 }, { 1, 0, 0 } };
+	for (int i = 0; i < 10; i++)
+		HandleGroundedMove(Slope, Stats, { -InvSqrt2, 0, InvSqrt2 }, 0.1f);
+	CHECK(NearlyEqual(Slope.Velocity, { 250, 0, 250 }));
+	// The result stays on the plane
+	CHECK(NearlyEqual(Slope.Velocity.X * -InvSqrt2 + Slope.Velocity.Z * InvSqrt2, 0.f));
+}
+
+static void TestHandleGravity()
+{
+	FMoveState State = { { 10, 20, 0 }, { 0, 0, 0 } };
+	HandleGravity(State, 980.f, 4000.f, 0.5f);
+	CHECK(NearlyEqual(State.Velocity, { 10, 20, -490 }));
+
+	// Clamped at the maximum fall speed
+	HandleGravity(State, 980.f, 600.f, 0.5f);
+	CHECK(NearlyEqual(State.Velocity.Z, -600.f));
+
+	// Upward velocity is only reduced
+	FMoveState Jumping = { { 0, 0, 800 }, { 0, 0, 0 } };
+	HandleGravity(Jumping, 980.f, 600.f, 0.5f);
+	CHECK(NearlyEqual(Jumping.Velocity.Z, 310.f));
+}
+
+static void TestValidGroundAngle()
+{
+	const float MinGroundNormalZ = std::cos(45.f * 3.14159265f / 180.f);
+	CHECK(ValidGroundAngle({ 0, 0, 1 }, MinGroundNormalZ));
+	CHECK(ValidGroundAngle({ 0.5f, 0, 0.866f }, MinGroundNormalZ));
+	CHECK(!ValidGroundAngle({ 0.866f, 0, 0.5f }, MinGroundNormalZ));
+	CHECK(!ValidGroundAngle({ 1, 0, 0 }, MinGroundNormalZ));
+	CHECK(!ValidGroundAngle({ 0, 0, -1 }, MinGroundNormalZ));
+}
+
+static void TestHandleMoveBatchMatchesScalar()
+{
+	// Not a multiple of four so the scalar tail is covered too
+	const int Count = 37;
+	std::vector<float> VelX(Count), VelY(Count), VelZ(Count);
+	std::vector<float> InputX(Count), InputY(Count), Acceleration(Count), Deceleration(Count), MaxSpeed(Count), FallAcceleration(Count), MaxFallSpeed(Count), DeltaTime(Count);
+	std::vector<FMoveState> Expected(Count);
+
+	unsigned Seed = 12345;
+	auto Random = [&Seed](float Min, float Max)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Min + (Max - Min) * ((Seed >> 8) / float(1 << 24));
+	};
+
+	for (int i = 0; i < Count; i++)
+	{
+		VelX[i] = Random(-800.f, 800.f);
+		VelY[i] = Random(-800.f, 800.f);
+		VelZ[i] = Random(-2000.f, 1000.f);
+		// Every few entries hit the decelerating and already-arrived branches
+		InputX[i] = i % 5 == 0 ? 0.f : Random(-1.f, 1.f);
+		InputY[i] = i % 5 == 0 ? 0.f : Random(-1.f, 1.f);
+		Acceleration[i] = i % 7 == 0 ? 0.f : Random(500.f, 3000.f);
+		Deceleration[i] = Random(500.f, 3000.f);
+		MaxSpeed[i] = Random(200.f, 900.f);
+		FallAcceleration[i] = Random(500.f, 3000.f);
+		MaxFallSpeed[i] = Random(500.f, 4000.f);
+		// Full rate and reduced rate gnomes share a batch
+		DeltaTime[i] = i % 3 == 0 ? 1.f / 20.f : 1.f / 60.f;
+		if (i % 11 == 0)
+		{
+			VelX[i] = InputX[i] * MaxSpeed[i];
+			VelY[i] = InputY[i] * MaxSpeed[i];
+		}
+		Expected[i] = { { VelX[i], VelY[i], VelZ[i] }, { InputX[i], InputY[i], 0 } };
+	}
+
+	for (int Frame = 0; Frame < 30; Frame++)
+	{
+		FMoveBatch Batch = { Count, VelX.data(), VelY.data(), VelZ.data(), InputX.data(), InputY.data(), Acceleration.data(), Deceleration.data(), MaxSpeed.data(), FallAcceleration.data(), MaxFallSpeed.data(), DeltaTime.data() };
+		HandleMoveBatch(Batch);
+		for (int i = 0; i < Count; i++)
+		{
+			HandleMove(Expected[i], { Acceleration[i], Deceleration[i], MaxSpeed[i] }, DeltaTime[i]);
+			HandleGravity(Expected[i], FallAcceleration[i], MaxFallSpeed[i], DeltaTime[i]);
+		}
+	}
+
+	for (int i = 0; i < Count; i++)
+		CHECK(NearlyEqual({ VelX[i], VelY[i], VelZ[i] }, Expected[i].Velocity));
+}
+
+int main()
+{
+	TestMoveVectorTowards();
+	TestHandleMove();
+	TestHandleGroundedMove();
+	TestHandleGravity();
+	TestValidGroundAngle();
+	TestHandleMoveBatchMatchesScalar();
+
+	if (Failures > 0)
+	{
+		std::printf("%d check(s) failed\n", Failures);
+		return 1;
+	}
+	std::printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomeNetMovement.h"
+#include "GardenGameCharacter.h"
+#include "Engine/NetSerialization.h"
+
+namespace
+{
+	void SerializeTime(FArchive& Ar, float& Time)
+	{
+		// Millisecond precision, up to a minute
+		uint16 Ms = (uint16)FMath::Clamp(FMath::RoundToInt(Time * 1000.f), 0, MAX_uint16);
+		Ar << Ms;
+		Time = Ms / 1000.f;
+	}
+}
+
+void FGnomeNetMove::SetMoveVector(const FVector& MoveVector)
+{
+	MoveX = (int8)FMath::Clamp(FMath::RoundToInt(MoveVector.X * 127.f), -127, 127);
+	MoveY = (int8)FMath::Clamp(FMath::RoundToInt(MoveVector.Y * 127.f), -127, 127);
+}
+
+FVector FGnomeNetMove::GetMoveVector() const
+{
+	return FVector(MoveX / 127.f, MoveY / 127.f, 0.f);
+}
+
+void FGnomeNetMove::SetDeltaTime(float DeltaTime)
+{
+	// Frames longer than a quarter second are simulated as a quarter second
+	DeltaMs = (uint8)FMath::Clamp(FMath::RoundToInt(DeltaTime * 1000.f), 1, 250);
+}
+
+bool FGnomeNetState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = SerializePackedVector<100, 30>(Location, Ar);
+	bOutSuccess &= SerializePackedVector<10, 24>(Velocity, Ar);
+	Ar << Yaw;
+	Ar << State;
+	Ar << Flags;
+	SerializeTime(Ar, JumpHeldTime);
+	SerializeTime(Ar, DodgeTime);
+	SerializeTime(Ar, AttackSpinTime);
+	SerializeTime(Ar, StunTimer);
+	// Only compared against the bounce cooldown, so clamping it at a minute is fine
+	SerializeTime(Ar, TimeSinceLastWallBounce);
+	Ar << DodgeState;
+
+	if (State == (uint8)CharacterState::Dodging)
+	{
+		bOutSuccess &= SerializePackedVector<100, 30>(DodgeStartPos, Ar);
+		bOutSuccess &= SerializePackedVector<100, 30>(DodgeEndPos, Ar);
+	}
+	return true;
+}
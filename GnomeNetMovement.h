@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GnomeNetMovement.generated.h"
+
+// Bits of FGnomeNetMove::Buttons
+enum EGnomeNetButton : uint8
+{
+	JumpHeld = 1 << 0,
+	DodgeHeld = 1 << 1,
+	AttackHeld = 1 << 2,
+	ThrowSeedHeld = 1 << 3,
+	JumpPress = 1 << 4,
+	DodgePress = 1 << 5,
+	AttackPress = 1 << 6,
+	ThrowSeedPress = 1 << 7
+};
+
+// One client tick of input, quantized to 4 bytes. The client simulates the quantized values too so both sides agree
+USTRUCT()
+struct FGnomeNetMove
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		int8 MoveX = 0;
+	UPROPERTY()
+		int8 MoveY = 0;
+	UPROPERTY()
+		uint8 Buttons = 0;
+	UPROPERTY()
+		uint8 DeltaMs = 0;
+
+	void SetMoveVector(const FVector& MoveVector);
+	FVector GetMoveVector() const;
+	void SetDeltaTime(float DeltaTime);
+	float GetDeltaTime() const { return DeltaMs / 1000.f; }
+};
+
+// Authoritative simulation state sent to correct the owning client and to update other clients
+USTRUCT()
+struct FGnomeNetState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		FVector Location = FVector::ZeroVector;
+	UPROPERTY()
+		FVector Velocity = FVector::ZeroVector;
+	UPROPERTY()
+		uint16 Yaw = 0;
+	UPROPERTY()
+		uint8 State = 0;
+	UPROPERTY()
+		uint8 Flags = 0;
+	UPROPERTY()
+		float JumpHeldTime = 0.f;
+	UPROPERTY()
+		float DodgeTime = 0.f;
+	UPROPERTY()
+		float AttackSpinTime = 0.f;
+	UPROPERTY()
+		float StunTimer = 0.f;
+	UPROPERTY()
+		float TimeSinceLastWallBounce = 0.f;
+	UPROPERTY()
+		uint8 DodgeState = 0;
+	// Only sent while dodging
+	UPROPERTY()
+		FVector DodgeStartPos = FVector::ZeroVector;
+	UPROPERTY()
+		FVector DodgeEndPos = FVector::ZeroVector;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGnomeNetState> : public TStructOpsTypeTraitsBase2<FGnomeNetState>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// Bits of FGnomeNetState::Flags
+enum EGnomeNetStateFlag : uint8
+{
+	DodgeConsumedFlag = 1 << 0,
+	CoyotteAvailableFlag = 1 << 1,
+	GlideHeldFlag = 1 << 2,
+	PerfectDodgeFlag = 1 << 3
+};
+
+// A predicted move kept by the owning client until the server acknowledges it
+struct FGnomeSavedMove
+{
+	uint16 Sequence;
+	FGnomeNetMove Move;
+	double SimulationTimeAfter;
+};
+
+// True when sequence A comes after B, allowing for wrap around
+inline bool IsNewerGnomeMove(uint16 A, uint16 B)
+{
+	return (int16)(A - B) > 0;
+}
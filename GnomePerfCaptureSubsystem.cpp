@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GnomePerfCaptureSubsystem.h"
+#include "GardenGameCharacter.h"
+#include "GardenGameCharacterStats.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// Every game world of a play session adds its rows to the same file, the first one to finish starts it.
+	// Reset whenever a game instance starts, so a new PIE session or process truncates what an earlier one left
+	bool HasStartedCapture = false;
+	bool HasBoundSessionStart = false;
+
+	void AppendRow(FString& Csv, const FString& World, const FString& Metric, TArray<float>& Samples)
+	{
+		if (Samples.Num() == 0)
+			return;
+
+		double Total = 0.0;
+		for (float Sample : Samples)
+			Total += Sample;
+		Samples.Sort();
+		int32 P99Index = FMath::Clamp(FMath::CeilToInt(Samples.Num() * 0.99f) - 1, 0, Samples.Num() - 1);
+		Csv += FString::Printf(TEXT("%s,%s,%d,%.4f,%.4f\n"), *World, *Metric, Samples.Num(), Total / Samples.Num(), Samples[P99Index]);
+	}
+}
+
+bool UGnomePerfCaptureSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	FString Path;
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld()
+		&& FParse::Value(FCommandLine::Get(), TEXT("GnomePerfCapture="), Path);
+}
+
+void UGnomePerfCaptureSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FParse::Value(FCommandLine::Get(), TEXT("GnomePerfCapture="), CapturePath);
+	StateTickTimes.SetNum(StaticEnum<CharacterState>()->NumEnums());
+	LastFrameTime = 0.0;
+	HasFlushed = false;
+	GGnomeQueryCounters.Reset();
+	if (!HasBoundSessionStart)
+	{
+		HasBoundSessionStart = true;
+		FWorldDelegates::OnStartGameInstance.AddLambda([](UGameInstance*) { HasStartedCapture = false; });
+	}
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UGnomePerfCaptureSubsystem::OnWorldPostActorTick);
+}
+
+void UGnomePerfCaptureSubsystem::Deinitialize()
+{
+	// Worlds that end without a replay finishing still get their rows
+	Flush();
+
+	Super::Deinitialize();
+}
+
+void UGnomePerfCaptureSubsystem::Flush()
+{
+	if (HasFlushed)
+		return;
+
+	HasFlushed = true;
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	if (Save())
+		UE_LOG(LogTemp, Log, TEXT("Saved %d frames of gnome perf capture to %s"), FrameTimes.Num(), *CapturePath);
+	else
+		UE_LOG(LogTemp, Error, TEXT("Could not save gnome perf capture %s"), *CapturePath);
+}
+
+void UGnomePerfCaptureSubsystem::RecordStateTick(uint8 State, double Seconds)
+{
+	// The sample arrays are not guarded, gnomes only simulate on the game thread
+	check(IsInGameThread());
+	if (!HasFlushed && StateTickTimes.IsValidIndex(State))
+		StateTickTimes[State].Add(Seconds * 1000.0);
+}
+
+void UGnomePerfCaptureSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World != GetWorld())
+		return;
+
+	// Wall time between frames, the delta time is fixed while a replay drives the engine
+	double Now = FPlatformTime::Seconds();
+	if (LastFrameTime > 0.0)
+		FrameTimes.Add((Now - LastFrameTime) * 1000.0);
+	LastFrameTime = Now;
+
+	GroundSweeps.Add(GGnomeQueryCounters.GroundSweeps.exchange(0, std::memory_order_relaxed));
+	EnemyQueries.Add(GGnomeQueryCounters.EnemyQueries.exchange(0, std::memory_order_relaxed));
+	MovementSweeps.Add(GGnomeQueryCounters.MovementSweeps.exchange(0, std::memory_order_relaxed));
+}
+
+bool UGnomePerfCaptureSubsystem::Save()
+{
+	// Sorts the samples for the percentiles, only call once the capture is over
+	bool IsAppending = HasStartedCapture && FPaths::FileExists(CapturePath);
+	FString Csv = IsAppending ? FString() : TEXT("World,Metric,Samples,Average,P99\n");
+	// PIE worlds carry their instance in the map name
+	FString World = GetWorld()->GetMapName();
+	AppendRow(Csv, World, TEXT("FrameMs"), FrameTimes);
+	const UEnum* StateEnum = StaticEnum<CharacterState>();
+	for (int32 State = 0; State < StateTickTimes.Num(); State++)
+		AppendRow(Csv, World, StateEnum->GetNameStringByIndex(State) + TEXT("TickMs"), StateTickTimes[State]);
+	AppendRow(Csv, World, TEXT("GroundSweepsPerFrame"), GroundSweeps);
+	AppendRow(Csv, World, TEXT("EnemyQueriesPerFrame"), EnemyQueries);
+	AppendRow(Csv, World, TEXT("MovementSweepsPerFrame"), MovementSweeps);
+
+	uint32 WriteFlags = IsAppending ? FILEWRITE_Append : FILEWRITE_None;
+	HasStartedCapture = true;
+	return FFileHelper::SaveStringToFile(Csv, *CapturePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), WriteFlags);
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GnomePerfCaptureSubsystem.generated.h"
+
+/**
+ * Collects per-state tick times and per-frame query counts of every gnome and adds them to a CSV when the replay or the world ends, one set of rows per world.
+ * The first world to finish in a play session starts the file over
+ * Query counts are process wide, so they are only meaningful with a single game world
+ * Only created with -GnomePerfCapture=<file>, usually together with -GnomeReplay=<file> -nullrhi -unattended
+ */
+UCLASS()
+class GARDENGAME_API UGnomePerfCaptureSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	void RecordStateTick(uint8 State, double Seconds);
+	// Writes this world's rows and stops capturing, later calls do nothing
+	void Flush();
+
+private:
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	bool Save();
+
+	FString CapturePath;
+	bool HasFlushed;
+	FDelegateHandle PostActorTickHandle;
+	double LastFrameTime;
+	// Milliseconds, indexed by CharacterState
+	TArray<TArray<float>> StateTickTimes;
+	TArray<float> FrameTimes;
+	TArray<float> GroundSweeps;
+	TArray<float> EnemyQueries;
+	TArray<float> MovementSweeps;
+};
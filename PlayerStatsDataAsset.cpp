@@ -3,3 +3,123 @@
 
 #include "PlayerStatsDataAsset.h"
 
+void FBakedCurve::Bake(const FRuntimeFloatCurve& Curve)
+{
+	const FRichCurve* RichCurve = Curve.GetRichCurveConst();
+	float EndTime = 0.f;
+	StartTime = 0.f;
+	if (RichCurve)
+		RichCurve->GetTimeRange(StartTime, EndTime);
+
+	float SegmentTime = (EndTime - StartTime) / NumSegments;
+	InvSegmentTime = SegmentTime > 0.f ? 1.f / SegmentTime : 0.f;
+	for (int32 i = 0; i <= NumSegments; i++)
+		Samples[i] = RichCurve ? RichCurve->Eval(StartTime + SegmentTime * i) : 0.f;
+}
+
+float FBakedCurve::Sample(float Time) const
+{
+	// Outside the key range the curve holds its end values
+	float Position = FMath::Clamp((Time - StartTime) * InvSegmentTime, 0.f, (float)NumSegments);
+	// Exact end value so callers can compare against it, a lerp with alpha 1 may round off
+	if (Position >= NumSegments)
+		return Samples[NumSegments];
+	int32 Index = FMath::Min((int32)Position, NumSegments - 1);
+	return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+}
+
+void UPlayerStatsDataAsset::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Assets created this session never go through PostLoad
+	BakeCurves();
+	BuildTickStats();
+#if WITH_EDITOR
+	if (!HasAnyFlags(RF_ClassDefaultObject))
+		ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddUObject(this, &UPlayerStatsDataAsset::OnObjectPropertyChanged);
+#endif
+}
+
+void UPlayerStatsDataAsset::PostLoad()
+{
+	Super::PostLoad();
+
+	BakeCurves();
+	BuildTickStats();
+}
+
+void UPlayerStatsDataAsset::BeginDestroy()
+{
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+#endif
+
+	Super::BeginDestroy();
+}
+
+#if WITH_EDITOR
+void UPlayerStatsDataAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BakeCurves();
+	BuildTickStats();
+}
+
+void UPlayerStatsDataAsset::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (Object && (Object == DodgeSpeedCurve.ExternalCurve || Object == AttackSpinUpCurve.ExternalCurve))
+		BakeCurves();
+}
+#endif
+
+void UPlayerStatsDataAsset::BakeCurves()
+{
+	BakedDodgeSpeedCurve.Bake(DodgeSpeedCurve);
+	BakedAttackSpinUpCurve.Bake(AttackSpinUpCurve);
+}
+
+void UPlayerStatsDataAsset::BuildTickStats()
+{
+	TickStats.BaseMoveSpeed = BaseMoveSpeed;
+	TickStats.BaseMoveAcceleration = BaseMoveAcceleration;
+	TickStats.BaseMoveDeceleration = BaseMoveDeceleration;
+	TickStats.GroundingDistance = GroundingDistance;
+	// Ground is walkable when the angle to up is at most MaxGroundSlopeAngle
+	TickStats.MinGroundNormalZ = FMath::Cos(FMath::DegreesToRadians(MaxGroundSlopeAngle));
+
+	TickStats.FallAcceleration = FallAcceleration;
+	TickStats.MaxFallSpeed = MaxFallSpeed;
+	TickStats.JumpForce = JumpForce;
+	TickStats.MinJumpHoldTime = MinJumpHoldTime;
+	TickStats.MaxJumpHoldTime = MaxJumpHoldTime;
+	TickStats.FallHorizontalAcceleration = FallHorizontalAcceleration;
+	TickStats.FallHorizontalDeceleration = FallHorizontalDeceleration;
+	TickStats.CoyotteTime = CoyotteTime;
+	TickStats.JumpBufferWindow = JumpBufferWindow;
+
+	TickStats.InputBufferWindow = InputBufferWindow;
+
+	TickStats.MaxGlideFallSpeed = MaxGlideFallSpeed;
+	TickStats.GlideHorizontalAcceleration = GlideHorizontalAcceleration;
+	TickStats.GlideHorizontalDeceleration = GlideHorizontalDeceleration;
+	TickStats.GlideMoveSpeed = GlideMoveSpeed;
+	TickStats.BoostAcceleration = BoostAcceleration;
+	TickStats.MaxGlideBoostSpeed = MaxGlideBoostSpeed;
+
+	TickStats.InvDodgeSpeed = DodgeSpeed != 0.f ? 1.f / DodgeSpeed : 0.f;
+	TickStats.PerfectDodgeWindow = PerfectDodgeWindow;
+
+	TickStats.AttackRange = AttackRange;
+	TickStats.SpinUpTime = SpinUpTime;
+	TickStats.InvSpinUpTime = SpinUpTime != 0.f ? 1.f / SpinUpTime : 0.f;
+	TickStats.AttackingMoveAcceleration = AttackingMoveAcceleration;
+	TickStats.AttackingMoveDeceleration = AttackingMoveDeceleration;
+	TickStats.AttackingMoveSpeed = AttackingMoveSpeed;
+	TickStats.MaxRotationSpeed = MaxRotationSpeed;
+	TickStats.StunTime = StunTime;
+
+	// A wall is bounced off when the impact is more than WallBounceAngle away from both straight up and straight down
+	WallBounceMaxUpDot = FMath::Cos(FMath::DegreesToRadians(WallBounceAngle));
+}
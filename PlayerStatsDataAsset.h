@@ -8,6 +8,70 @@
 #include "Curves/CurveFloat.h"
 #include "PlayerStatsDataAsset.generated.h"
 
+// A float curve sampled at evenly spaced times across its key range, cheap to evaluate at runtime
+struct FBakedCurve
+{
+	static constexpr int32 NumSegments = 64;
+
+	void Bake(const FRuntimeFloatCurve& Curve);
+	float Sample(float Time) const;
+
+private:
+	float StartTime = 0.f;
+	float InvSegmentTime = 0.f;
+	float Samples[NumSegments + 1] = {};
+};
+
+// The tuning values read every tick plus values derived from them, rebuilt on load and edit.
+// Kept together so a tick touches a couple of cache lines instead of the whole asset,
+// values only read on a wall hit or when a dodge ends (wall bounce, dodge spin slow down) stay on the asset
+struct alignas(64) FPlayerTickStats
+{
+	// Movement
+	float BaseMoveSpeed;
+	float BaseMoveAcceleration;
+	float BaseMoveDeceleration;
+	float GroundingDistance;
+	float MinGroundNormalZ;
+
+	// Jumping
+	float FallAcceleration;
+	float MaxFallSpeed;
+	float JumpForce;
+	float MinJumpHoldTime;
+	float MaxJumpHoldTime;
+	float FallHorizontalAcceleration;
+	float FallHorizontalDeceleration;
+	float CoyotteTime;
+	float JumpBufferWindow;
+
+	// Input
+	float InputBufferWindow;
+
+	// Gliding
+	float MaxGlideFallSpeed;
+	float GlideHorizontalAcceleration;
+	float GlideHorizontalDeceleration;
+	float GlideMoveSpeed;
+	float BoostAcceleration;
+	float MaxGlideBoostSpeed;
+
+	// Dodge
+	float InvDodgeSpeed;
+	float PerfectDodgeWindow;
+
+	// Attack
+	float AttackRange;
+	float SpinUpTime;
+	float InvSpinUpTime;
+	float AttackingMoveAcceleration;
+	float AttackingMoveDeceleration;
+	float AttackingMoveSpeed;
+	float MaxRotationSpeed;
+	float StunTime;
+};
+static_assert(sizeof(FPlayerTickStats) <= 128, "FPlayerTickStats should stay within two cache lines");
+
 /**
  *
  */
@@ -17,6 +81,20 @@ class GARDENGAME_API UPlayerStatsDataAsset : public UDataAsset
 	GENERATED_BODY()
 
 public:
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	void BakeCurves();
+	void BuildTickStats();
+	const FPlayerTickStats& GetTickStats() const { return TickStats; }
+	float SampleDodgeSpeed(float Time) const { return BakedDodgeSpeedCurve.Sample(Time); }
+	float SampleAttackSpinUp(float Time) const { return BakedAttackSpinUpCurve.Sample(Time); }
+	float GetWallBounceMaxUpDot() const { return WallBounceMaxUpDot; }
+
 	// Movement
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement")
 		float BaseMoveSpeed;
@@ -57,6 +135,10 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jumping")
 		float CoyotteTime;
 
+	// Input
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input")
+		float InputBufferWindow = 0.15f;
+
 	// Gliding
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gliding")
 		float MaxGlideFallSpeed;
@@ -121,4 +203,15 @@ public:
 	// Planting
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Cheering")
 		float CheeringDuration;
+
+private:
+	FPlayerTickStats TickStats;
+	FBakedCurve BakedDodgeSpeedCurve;
+	FBakedCurve BakedAttackSpinUpCurve;
+	float WallBounceMaxUpDot = 1.f;
+#if WITH_EDITOR
+	// External curve assets are edited on their own, the baked samples follow them
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+	FDelegateHandle ObjectPropertyChangedHandle;
+#endif
 };